@@ -0,0 +1,148 @@
+// Decoded instruction layout benchmark
+//
+// Walks a large working set of decoded instructions, laid out like the
+// translated-block stream (fields, handler, pc, length, cycles), in the
+// current packed InstructionFields and in the previous unpacked layout.
+// Execution order is straight-line runs of 8 instructions with a jump to a
+// pseudo-random entry after each run, and every step reads the fields the
+// execute handlers read. The packed stream touches fewer cache lines; run it
+// under cachegrind to count L1D misses per layout:
+//
+//   valgrind --tool=cachegrind --cache-sim=yes decoded_stream_bench legacy
+//   valgrind --tool=cachegrind --cache-sim=yes decoded_stream_bench packed
+//
+//   decoded_stream_bench [legacy|packed|both] [entries] [steps]
+
+#include "Instruction.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace ARM_CORE_NAMESPACE;
+
+// InstructionFields before it was packed into 16 bytes
+struct LegacyFields {
+    uint32_t opcode;
+    uint8_t rd;
+    uint8_t rn;
+    uint8_t rm;
+    uint8_t rs;
+    uint32_t imm;
+    uint8_t cond;
+    bool s_bit;
+    uint8_t shift_type;
+    uint8_t shift_amount;
+    uint8_t alu_op;
+    bool h1, h2;
+    uint16_t reg_list;
+    bool load_store_bit;
+    uint8_t byte_word;
+    bool pre_indexed;
+    bool writeback;
+    bool negative_offset;
+    bool is_32bit;
+    uint8_t addressing_mode;
+    InstructionType type;
+};
+
+typedef uint32_t (*Handler)(uint32_t value);
+
+// Same shape as BlockInstruction
+template<typename Fields>
+struct StreamEntry {
+    Fields fields;
+    Handler handler;
+    uint32_t pc;
+    uint8_t length;
+    uint8_t cycles;
+};
+
+static uint32_t handler_add(uint32_t value) { return value + 1; }
+static uint32_t handler_xor(uint32_t value) { return value ^ 0x5A5A5A5Au; }
+
+template<typename Fields>
+static std::vector<StreamEntry<Fields>> build_stream(size_t entries)
+{
+    std::vector<StreamEntry<Fields>> stream(entries);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < entries; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        StreamEntry<Fields>& entry = stream[i];
+        std::memset(&entry.fields, 0, sizeof(entry.fields));
+        entry.fields.opcode = seed;
+        entry.fields.rd = seed & 7;
+        entry.fields.rn = (seed >> 3) & 7;
+        entry.fields.rm = (seed >> 6) & 7;
+        entry.fields.imm = seed >> 12;
+        entry.fields.cond = (seed >> 9) & 0xF;
+        entry.fields.s_bit = (seed >> 13) & 1;
+        entry.fields.type = static_cast<InstructionType>((seed >> 16) % INST_TYPE_COUNT);
+        entry.handler = (seed & 0x100) ? handler_add : handler_xor;
+        entry.pc = static_cast<uint32_t>(i * 2);
+        entry.length = 2;
+        entry.cycles = 1;
+    }
+    return stream;
+}
+
+// Returns a checksum so the reads cannot be optimized away
+template<typename Fields>
+static uint32_t walk(const std::vector<StreamEntry<Fields>>& stream, uint64_t steps)
+{
+    uint32_t regs[8] = { 0 };
+    uint32_t seed = 7;
+    size_t index = 0;
+    size_t entries = stream.size();
+    for (uint64_t step = 0; step < steps; step++) {
+        const StreamEntry<Fields>& entry = stream[index];
+        uint32_t value = regs[entry.fields.rn] + regs[entry.fields.rm] + entry.fields.imm;
+        if (entry.fields.cond != 0xF && entry.fields.type != INST_UNKNOWN) {
+            value = entry.handler(value);
+        }
+        regs[entry.fields.rd] = value + (entry.fields.s_bit ? entry.cycles : entry.length) + entry.pc;
+        if ((step & 7) == 7) {
+            seed = seed * 1664525u + 1013904223u;
+            index = (seed >> 8) % entries;
+        } else if (++index == entries) {
+            index = 0;
+        }
+    }
+    return regs[0] ^ regs[1] ^ regs[2] ^ regs[3] ^ regs[4] ^ regs[5] ^ regs[6] ^ regs[7];
+}
+
+template<typename Fields>
+static void run(const char* name, size_t entries, uint64_t steps)
+{
+    std::vector<StreamEntry<Fields>> stream = build_stream<Fields>(entries);
+    auto start = std::chrono::steady_clock::now();
+    uint32_t checksum = walk(stream, steps);
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%-8s %6zu B/entry %8zu KB %10.2f ns/step (checksum %08x)\n", name, sizeof(StreamEntry<Fields>),
+           sizeof(StreamEntry<Fields>) * entries / 1024, elapsed.count() / static_cast<double>(steps), checksum);
+}
+
+int main(int argc, char* argv[])
+{
+    const char* layout = argc > 1 ? argv[1] : "both";
+    size_t entries = argc > 2 ? std::strtoul(argv[2], nullptr, 0) : 65536;
+    uint64_t steps = argc > 3 ? std::strtoull(argv[3], nullptr, 0) : 100000000;
+    if (entries == 0) {
+        fprintf(stderr, "entries must be at least 1\n");
+        return 1;
+    }
+
+    bool both = std::strcmp(layout, "both") == 0;
+    if (!both && std::strcmp(layout, "legacy") != 0 && std::strcmp(layout, "packed") != 0) {
+        fprintf(stderr, "Unknown layout: %s (expected legacy, packed or both)\n", layout);
+        return 1;
+    }
+    if (both || std::strcmp(layout, "legacy") == 0) {
+        run<LegacyFields>("legacy", entries, steps);
+    }
+    if (both || std::strcmp(layout, "packed") == 0) {
+        run<InstructionFields>("packed", entries, steps);
+    }
+    return 0;
+}
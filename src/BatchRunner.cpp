@@ -0,0 +1,251 @@
+#include "BatchRunner.h"
+#include "Performance.h"
+#include "Log.h"
+#include "SimulationControl.h"
+#include <systemc>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+namespace {
+
+double wall_clock()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string json_string(const std::string& text)
+{
+    std::ostringstream out;
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                } else {
+                    out << c;
+                }
+                break;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(unsigned jobs) :
+    m_jobs(jobs ? jobs : 1)
+{
+}
+
+bool BatchRunner::read_list(const std::string& list_file, std::vector<std::string>& images)
+{
+    std::ifstream list(list_file);
+    if (!list) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(list, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r");
+        images.push_back(line.substr(begin, end - begin + 1));
+    }
+    return true;
+}
+
+std::vector<std::string> BatchRunner::log_prefixes(const std::vector<std::string>& images) const
+{
+    std::vector<std::string> prefixes(images.size());
+    if (m_log_dir.empty()) {
+        return prefixes;
+    }
+    std::vector<std::string> stems;
+    std::map<std::string, unsigned> uses;
+    for (const std::string& image : images) {
+        std::string stem = image.substr(image.find_last_of('/') + 1);
+        size_t dot = stem.find_last_of('.');
+        if (dot != std::string::npos && dot > 0) {
+            stem = stem.substr(0, dot);
+        }
+        stems.push_back(stem);
+        uses[stem]++;
+    }
+    // Images sharing a stem (same name, different directories) get their
+    // position in the list appended so their files do not overwrite each other
+    for (size_t i = 0; i < images.size(); i++) {
+        prefixes[i] = m_log_dir + "/" + stems[i];
+        if (uses[stems[i]] > 1) {
+            prefixes[i] += "-" + std::to_string(i + 1);
+        }
+    }
+    return prefixes;
+}
+
+int BatchRunner::run(const std::string& list_file, const std::string& results_file, const RunFunction& run_test)
+{
+    std::vector<std::string> images;
+    if (!read_list(list_file, images)) {
+        std::cerr << "Cannot read batch list: " << list_file << std::endl;
+        return 1;
+    }
+    std::ofstream results(results_file);
+    if (!results) {
+        std::cerr << "Cannot create batch results file: " << results_file << std::endl;
+        return 1;
+    }
+    if (!m_log_dir.empty()) {
+        mkdir(m_log_dir.c_str(), 0755);
+    }
+    std::vector<std::string> prefixes = log_prefixes(images);
+
+    std::cout << "Running " << images.size() << " tests with " << m_jobs << " workers" << std::endl;
+
+    std::vector<Worker> running;
+    size_t next = 0;
+    size_t finished = 0;
+    size_t failed = 0;
+    while (next < images.size() || !running.empty()) {
+        // Keep every worker slot busy
+        while (next < images.size() && running.size() < m_jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                std::cerr << "Cannot create result pipe" << std::endl;
+                return 1;
+            }
+            // Nothing buffered may be inherited (and written twice) by the worker
+            std::cout.flush();
+            std::cerr.flush();
+            results.flush();
+
+            int pid = fork();
+            if (pid == 0) {
+                close(fds[0]);
+                for (const Worker& worker : running) {
+                    close(worker.result_fd);
+                }
+                run_worker(images[next], prefixes[next], fds[1], run_test);
+            }
+            close(fds[1]);
+            if (pid < 0) {
+                close(fds[0]);
+                std::cerr << "Cannot start batch worker" << std::endl;
+                return 1;
+            }
+            running.push_back({ pid, fds[0], next, wall_clock() });
+            next++;
+        }
+
+        int status = 0;
+        int pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        size_t slot = 0;
+        while (slot < running.size() && running[slot].pid != pid) {
+            slot++;
+        }
+        if (slot == running.size()) {
+            continue; // Not one of ours
+        }
+        Worker worker = running[slot];
+        running.erase(running.begin() + slot);
+        double wall_time = wall_clock() - worker.start;
+
+        // The worker reports once, just before it exits
+        std::string report;
+        char buffer[512];
+        ssize_t count;
+        while ((count = read(worker.result_fd, buffer, sizeof(buffer))) > 0) {
+            report.append(buffer, static_cast<size_t>(count));
+        }
+        close(worker.result_fd);
+
+        bool passed = !report.empty() && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        if (report.empty()) {
+            // Crashed or killed before it could report
+            std::string reason = WIFSIGNALED(status) ? "killed by signal " + std::to_string(WTERMSIG(status))
+                                                     : "no result from worker";
+            report = "\"exit_code\": null, \"reason\": " + json_string(reason) +
+                     ", \"instructions\": null, \"sim_time_ns\": null";
+        }
+        const std::string& image = images[worker.index];
+        results << "{\"image\": " << json_string(image) << ", " << report
+                << ", \"wall_time_s\": " << std::fixed << std::setprecision(3) << wall_time << "}" << std::endl;
+
+        finished++;
+        if (!passed) {
+            failed++;
+        }
+        std::cout << "[" << finished << "/" << images.size() << "] " << (passed ? "PASS " : "FAIL ")
+                  << image << " (" << std::fixed << std::setprecision(2) << wall_time << "s)" << std::endl;
+    }
+
+    std::cout << "Batch done: " << (finished - failed) << " passed, " << failed << " failed; results in "
+              << results_file << std::endl;
+    return failed == 0 && finished == images.size() ? 0 : 1;
+}
+
+void BatchRunner::run_worker(const std::string& image, const std::string& prefix, int result_fd,
+                             const RunFunction& run_test)
+{
+    // Console output goes to the test's .out file, or nowhere
+    std::string out_file = prefix.empty() ? "/dev/null" : prefix + ".out";
+    int out = open(out_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out != -1) {
+        dup2(out, STDOUT_FILENO);
+        dup2(out, STDERR_FILENO);
+        close(out);
+    }
+
+    int code = 1;
+    std::string reason;
+    try {
+        code = run_test(image, prefix);
+    } catch (const std::exception& e) {
+        reason = e.what();
+    }
+    if (reason.empty()) {
+        if (SimulationControl::exit_requested()) {
+            reason = SimulationControl::exit_reason();
+        } else if (code == 124) {
+            reason = "limit reached";
+        }
+    }
+
+    std::ostringstream report;
+    report << "\"exit_code\": " << code
+           << ", \"reason\": " << json_string(reason)
+           << ", \"instructions\": " << Performance::getInstance().get_instructions_executed()
+           << ", \"sim_time_ns\": " << static_cast<uint64_t>(sc_core::sc_time_stamp() / sc_core::sc_time(1, sc_core::SC_NS));
+    std::string text = report.str();
+    ssize_t written = write(result_fd, text.data(), text.size());
+    (void) written;
+    close(result_fd);
+
+    // Skip static destructors (SystemC kernel); flush what exit() would
+    std::cout.flush();
+    std::cerr.flush();
+    Log::getInstance().close();
+    _exit(code == 0 ? 0 : 1);
+}
@@ -0,0 +1,53 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Runs a list of firmware images, each in its own forked worker process,
+// up to `jobs` at a time. SystemC elaborates one design per process, so
+// workers are processes rather than threads; they share the parent's
+// loaded binary and parsed options through fork() instead of paying a
+// fresh exec per test.
+//
+// Every finished test appends one JSON object to the results file (JSON
+// Lines, in completion order):
+//   {"image": "...", "exit_code": 0, "reason": "...", "instructions": 1234,
+//    "sim_time_ns": 5678, "wall_time_s": 0.012}
+class BatchRunner
+{
+public:
+    // Runs one test inside the worker. log_prefix is "<log dir>/<image stem>"
+    // ("<image stem>-<list position>" when several images share a stem), or empty
+    // when no log directory was given. Returns the exit code.
+    typedef std::function<int(const std::string& image, const std::string& log_prefix)> RunFunction;
+
+    explicit BatchRunner(unsigned jobs);
+
+    // Keep each test's console output (<stem>.out) and log (<stem>.log) in dir
+    void set_log_dir(const std::string& dir) { m_log_dir = dir; }
+
+    // Run every image listed in list_file (one path per line; blank lines and
+    // '#' comments are skipped). Returns 0 if every test exited with 0.
+    int run(const std::string& list_file, const std::string& results_file, const RunFunction& run_test);
+
+private:
+    struct Worker {
+        int pid;
+        int result_fd;          // Read end of the worker's result pipe
+        size_t index;           // Position in the image list
+        double start;           // Wall clock at fork, seconds
+    };
+
+    unsigned m_jobs;
+    std::string m_log_dir;
+
+    static bool read_list(const std::string& list_file, std::vector<std::string>& images);
+    std::vector<std::string> log_prefixes(const std::vector<std::string>& images) const;
+    // Worker side: run the test, report through result_fd and exit
+    [[noreturn]] void run_worker(const std::string& image, const std::string& prefix, int result_fd,
+                                 const RunFunction& run_test);
+};
+
+#endif // BATCH_RUNNER_H
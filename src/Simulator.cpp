@@ -1,19 +1,33 @@
 #include "Simulator.h"
+#include "Checkpoint.h"
+#include "Registers.h"
 #include <iostream>
+#include <fstream>
+#include <stdexcept>
 
-Simulator::Simulator(sc_module_name name, const std::string& hex_file) : 
+Simulator::Simulator(sc_module_name name, const std::string& hex_file,
+                     const std::vector<MemoryRegion>& memory_regions,
+                     const std::string& core, ImageFormat format) : 
     sc_module(name),
     m_hex_file(hex_file),
+    m_image_format(format),
+    m_core(core),
+    m_memory_regions(memory_regions),
+    m_entry_point(0),
+    m_profiler(nullptr),
+    m_inst_trace(nullptr),
     m_performance_enabled(true),
     m_cpu(nullptr),
     m_memory(nullptr),
     m_bus_ctrl(nullptr),
     m_trace(nullptr),
     m_nvic(nullptr),
+    m_uart(nullptr),
     m_gdb_server(nullptr),
-    m_gdb_enabled(false)
+    m_gdb_enabled(false),
+    m_register_stats(false)
 {
-    LOG_INFO("Initializing ARM Cortex-M0 SystemC-TLM Simulator");
+    LOG_INFO("Initializing ARM " + core + " SystemC-TLM Simulator");
     
     initialize_components();
     connect_components();
@@ -37,11 +51,16 @@ void Simulator::initialize_components()
     LOG_INFO("Creating simulator components...");
     
     // Create components
-    m_cpu = new CPU("cpu");
-    m_memory = new Memory("memory", 0x100000); // 1MB memory
+    m_cpu = CPUCore::create(m_core, "cpu");
+    if (!m_cpu) {
+        throw std::runtime_error("Core not available in this build: " + m_core);
+    }
+    LOG_INFO(std::string("CPU core: ") + m_cpu->core_name() + " (" + m_cpu->arch_name() + ")");
+    m_memory = new Memory("memory", m_memory_regions);
     m_bus_ctrl = new BusCtrl("bus_ctrl");
     m_trace = new Trace("trace");
     m_nvic = new NVIC("nvic");
+    m_uart = new InteractiveUART("uart0", 0, "none", UART0_IRQ);
     
     LOG_INFO("All components created successfully");
 }
@@ -73,6 +92,12 @@ void Simulator::connect_components()
         nvic_socket->bind(m_nvic->socket);
     }
     
+    auto* uart_socket = m_bus_ctrl->get_device_socket("uart0");
+    if (uart_socket) {
+        uart_socket->bind(m_uart->socket);
+    }
+    m_uart->irq_socket.bind(m_nvic->irq_socket);
+    
     // Connect NVIC to CPU for exception delivery
     m_nvic->cpu_socket.bind(m_cpu->irq_line);
 
@@ -84,9 +109,20 @@ void Simulator::setup_memory_map()
     LOG_INFO("Setting up memory map...");
     
     // Add standard devices
-    m_bus_ctrl->add_memory(0x00000000, 0x40000000);     // Main memory space
     m_bus_ctrl->add_trace_peripheral(0x40000000, 0x4000);  // Trace peripheral  
+    m_bus_ctrl->add_uart("uart0", 0x40004000, 0x1000);     // Interactive UART
     m_bus_ctrl->add_nvic(0xE000E000, 0x1000);              // ARM NVIC
+
+    // Memory is decoded only where a region exists (a region overlapping a
+    // peripheral is rejected); instruction fetches are refused from regions
+    // without the x attribute
+    for (const MemoryRegion& region : m_memory->regions()) {
+        m_bus_ctrl->add_memory(region.base, region.size, (region.attributes & MEM_EXEC) != 0);
+        // Regions the bus cannot write are flash/ROM: their fetches pay wait states
+        if (!(region.attributes & MEM_WRITE)) {
+            m_cpu->add_flash_region(region.base, region.size);
+        }
+    }
     
     // Print the memory map
     m_bus_ctrl->print_memory_map();
@@ -100,11 +136,36 @@ bool Simulator::load_program()
     }
     
     LOG_INFO("Loading program from: " + m_hex_file);
-    
-    if (!m_memory->load_hex_file(m_hex_file)) {
-        LOG_ERROR("Failed to load HEX file: " + m_hex_file);
+
+    // Use the format asked for; otherwise pick it from the file contents / extension
+    ImageFormat format = m_image_format;
+    if (format == IMAGE_AUTO) {
+        std::ifstream file(m_hex_file, std::ios::binary);
+        char magic[4] = { 0 };
+        file.read(magic, sizeof(magic));
+        bool is_elf = file.gcount() == 4 && magic[0] == 0x7F && magic[1] == 'E' && magic[2] == 'L' && magic[3] == 'F';
+        size_t dot = m_hex_file.find_last_of('.');
+        bool is_bin = dot != std::string::npos && m_hex_file.substr(dot) == ".bin";
+        format = is_elf ? IMAGE_ELF : is_bin ? IMAGE_BIN : IMAGE_HEX;
+    }
+
+    bool loaded;
+    switch (format) {
+        case IMAGE_ELF:
+            loaded = m_memory->load_elf_file(m_hex_file, &m_entry_point, &m_symbols);
+            break;
+        case IMAGE_BIN:
+            loaded = m_memory->load_bin_file(m_hex_file, 0x00000000);
+            break;
+        default:
+            loaded = m_memory->load_hex_file(m_hex_file, &m_entry_point);
+            break;
+    }
+    if (!loaded) {
+        LOG_ERROR("Failed to load program file: " + m_hex_file);
         return false;
     }
+    m_cpu->set_entry_point(m_entry_point);
     
     LOG_INFO("Program loaded successfully");
     return true;
@@ -140,10 +201,19 @@ void Simulator::run_simulation(sc_time duration)
         // Run for specified duration
         sc_start(duration);
     }
+    // Let queued log output reach the console before the report
+    Log::getInstance().flush();
     
     if (m_performance_enabled) {
         Performance::getInstance().stop_timing();
     }
+    if (m_profiler) {
+        m_profiler->write_reports(m_profile_prefix);
+    }
+    if (m_inst_trace) {
+        m_inst_trace->close();
+        LOG_INFO("Instruction trace written: " + std::to_string(m_inst_trace->instructions()) + " instructions");
+    }
     
     LOG_INFO("Simulation completed");
     print_final_report();
@@ -155,6 +225,63 @@ void Simulator::stop_simulation()
     sc_stop();
 }
 
+bool Simulator::save_checkpoint(const std::string& path)
+{
+    CheckpointWriter out(path);
+    if (!out.ok()) {
+        LOG_ERROR("Cannot create checkpoint file: " + path);
+        return false;
+    }
+
+    out.section("TIME");
+    out.put_u64(sc_time_stamp().value());
+    out.put_u64(static_cast<uint64_t>(sc_get_time_resolution() / sc_time(1, SC_FS)));
+
+    m_cpu->save_state(out);
+    m_nvic->save_state(out);
+    m_uart->save_state(out);
+    m_memory->save_state(out);
+    if (!out.ok()) {
+        LOG_ERROR("Failed to write checkpoint file: " + path);
+        return false;
+    }
+
+    LOG_INFO("Checkpoint saved at " + sc_time_stamp().to_string() + ": " + path);
+    return true;
+}
+
+bool Simulator::restore_checkpoint(const std::string& path)
+{
+    CheckpointReader in(path);
+    if (!in.ok()) {
+        LOG_ERROR("Not a checkpoint file (or unsupported version): " + path);
+        return false;
+    }
+
+    if (!in.section("TIME")) {
+        LOG_ERROR("Corrupt checkpoint file: " + path);
+        return false;
+    }
+    uint64_t time_value = in.get_u64();
+    uint64_t resolution_fs = in.get_u64();
+    if (resolution_fs != static_cast<uint64_t>(sc_get_time_resolution() / sc_time(1, SC_FS))) {
+        LOG_ERROR("Checkpoint was taken with a different time resolution: " + path);
+        return false;
+    }
+    sc_time resume_time = sc_time::from_value(time_value);
+
+    if (!m_cpu->restore_state(in, resume_time) ||
+        !m_nvic->restore_state(in, resume_time) ||
+        !m_uart->restore_state(in) ||
+        !m_memory->restore_state(in)) {
+        LOG_ERROR("Failed to restore checkpoint: " + path);
+        return false;
+    }
+
+    LOG_INFO("Checkpoint restored, resuming at " + resume_time.to_string() + ": " + path);
+    return true;
+}
+
 void Simulator::print_final_report()
 {
     if (m_performance_enabled) {
@@ -172,19 +299,83 @@ void Simulator::cleanup()
     }
     
     delete m_cpu;
+    delete m_profiler;
+    delete m_inst_trace;
     delete m_memory;
     delete m_bus_ctrl;
     delete m_trace;
     delete m_nvic;
+    delete m_uart;
     
     m_cpu = nullptr;
+    m_profiler = nullptr;
+    m_inst_trace = nullptr;
     m_memory = nullptr;
     m_bus_ctrl = nullptr;
     m_trace = nullptr;
     m_nvic = nullptr;
+    m_uart = nullptr;
     m_gdb_server = nullptr;
 }
 
+void Simulator::set_log_level(LogLevel level)
+{
+    Log::getInstance().set_log_level(level);
+    update_register_tracking();
+}
+
+void Simulator::enable_register_stats(bool enable)
+{
+    m_register_stats = enable;
+    update_register_tracking();
+}
+
+void Simulator::update_register_tracking()
+{
+    // TRACE logging prints every register access, so it needs the hook as well
+    m_cpu->get_registers()->set_access_tracking(m_register_stats || m_inst_trace || LOG_ENABLED(LOG_TRACE));
+}
+
+void Simulator::set_core_clock(double hz)
+{
+    m_cpu->set_clock_frequency(hz);
+    m_nvic->set_clock_period(m_cpu->get_cycle_time());
+    LOG_INFO("Core clock: " + std::to_string(hz / 1e6) + " MHz");
+}
+
+void Simulator::set_flash_wait_states(uint32_t wait_states)
+{
+    m_cpu->set_flash_wait_states(wait_states);
+}
+
+void Simulator::enable_profiling(const std::string& prefix)
+{
+    if (!m_profiler) {
+        m_profiler = new Profiler(m_symbols.empty() ? nullptr : &m_symbols);
+        m_cpu->set_profiler(m_profiler);
+    }
+    m_profile_prefix = prefix;
+    LOG_INFO("Profiling enabled, output prefix: " + prefix);
+}
+
+bool Simulator::enable_instruction_trace(const std::string& path, bool compress)
+{
+    if (!m_inst_trace) {
+        m_inst_trace = new InstructionTrace();
+    }
+    if (!m_inst_trace->open(path, compress)) {
+        LOG_ERROR("Cannot create instruction trace: " + path);
+        delete m_inst_trace;
+        m_inst_trace = nullptr;
+        return false;
+    }
+    m_cpu->set_instruction_trace(m_inst_trace);
+    // Register writes reach the trace through the access tracking hook
+    update_register_tracking();
+    LOG_INFO("Instruction trace: " + path + (compress ? " (compressed)" : ""));
+    return true;
+}
+
 void Simulator::enable_gdb_server(int port)
 {
     if (m_gdb_server) {
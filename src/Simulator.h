@@ -3,58 +3,118 @@
 
 #include <systemc>
 #include <string>
-#include "CPU.h"
+#include <vector>
+#include "CPUCore.h"
 #include "Memory.h"
 #include "BusCtrl.h"
 #include "Trace.h"
 #include "NVIC.h"
+#include "InteractiveUART.h"
 #include "Performance.h"
 #include "Log.h"
 #include "GDBServer.h"
+#include "SymbolTable.h"
+#include "Profiler.h"
+#include "InstructionTrace.h"
 
 using namespace sc_core;
 
+// Program image format; IMAGE_AUTO picks it from the ELF magic or a ".bin"
+// extension and otherwise reads Intel HEX
+enum ImageFormat {
+    IMAGE_AUTO = 0,
+    IMAGE_HEX,
+    IMAGE_ELF,
+    IMAGE_BIN
+};
+
 class Simulator : public sc_module
 {
 public:
     // Constructor
     SC_HAS_PROCESS(Simulator);
-    Simulator(sc_module_name name, const std::string& hex_file = "");
+    Simulator(sc_module_name name, const std::string& hex_file = "",
+              const std::vector<MemoryRegion>& memory_regions = std::vector<MemoryRegion>(),
+              const std::string& core = "Cortex-M0+", ImageFormat format = IMAGE_AUTO);
 
     // Destructor
     ~Simulator();
 
     // Configuration
     void set_hex_file(const std::string& hex_file) { m_hex_file = hex_file; }
-    void set_log_level(LogLevel level) { Log::getInstance().set_log_level(level); }
+    const SymbolTable& get_symbols() const { return m_symbols; }
+    uint32_t get_entry_point() const { return m_entry_point; }
+    void set_log_level(LogLevel level);
     void set_log_file(const std::string& log_file) { Log::getInstance().set_log_file(log_file); }
+    // Write log output from a background thread (see Log::enable_async)
+    void enable_async_log(LogOverflowPolicy policy) { Log::getInstance().enable_async(policy); }
     void enable_performance_monitoring(bool enable) { m_performance_enabled = enable; }
+    // Count register reads/writes in the performance report (costs a call per access)
+    void enable_register_stats(bool enable);
+    void set_engine(ExecutionEngine engine) { m_cpu->set_engine(engine); }
+    // Trace peripheral sink: stdout, file:<path>, pty or null
+    bool set_trace_output(const std::string& spec) { return m_trace->set_output(spec); }
+    // UART0 receive source: pty, file:<path>, stdin or none (see InteractiveUART::set_input)
+    bool set_uart_input(const std::string& spec) { return m_uart->set_input(spec); }
+    void set_quantum(const sc_time& quantum) { CPUCore::set_global_quantum(quantum); }
+    // Core clock: scales instruction cycles and SysTick ticks to simulated time
+    void set_core_clock(double hz);
+    void set_flash_wait_states(uint32_t wait_states);
+    // Per-PC profile written as <prefix>.txt and <prefix>.folded when the run ends
+    void enable_profiling(const std::string& prefix);
+    // Binary execution trace (instructions, register writes, data accesses),
+    // optionally block-compressed; decode with tools/trace_decode.py
+    bool enable_instruction_trace(const std::string& path, bool compress);
     void enable_gdb_server(int port = 3333);
     void disable_gdb_server();
 
     // Simulation control
     void run_simulation(sc_time duration = SC_ZERO_TIME);
     void stop_simulation();
+    // Stop on the first instruction boundary at or after this (absolute) time
+    void set_stop_time(const sc_time& t) { m_cpu->set_stop_time(t); }
+    void set_max_instructions(uint64_t count) { m_cpu->set_max_instructions(count); }
+
+    // Checkpoints: registers, pending exceptions, NVIC/SysTick, UART, non-zero memory
+    // pages and the simulation time. Save after run_simulation() returns;
+    // restore before the first run_simulation().
+    bool save_checkpoint(const std::string& path);
+    bool restore_checkpoint(const std::string& path);
     
 private:
+    static const uint32_t UART0_IRQ = 1;  // UART0 interrupt line on the NVIC
+
     // Components
-    CPU* m_cpu;
+    CPUCore* m_cpu;
     Memory* m_memory;
     BusCtrl* m_bus_ctrl;
     Trace* m_trace;
     NVIC* m_nvic;
+    InteractiveUART* m_uart;
     GDBServer* m_gdb_server;
     
     // Configuration
     std::string m_hex_file;
+    ImageFormat m_image_format;
+    std::string m_core;                          // Core model name (--core)
+    std::vector<MemoryRegion> m_memory_regions;  // Empty: Memory::default_regions()
+
+    // Program image information (ELF / HEX start record)
+    uint32_t m_entry_point;
+    SymbolTable m_symbols;
+    Profiler* m_profiler;
+    std::string m_profile_prefix;
+    InstructionTrace* m_inst_trace;
     bool m_performance_enabled;
     bool m_gdb_enabled;
+    bool m_register_stats;
     
     // Initialization and helper methods
     void initialize_components();
     void setup_memory_map();
     void connect_components();
     bool load_program();
+    void update_register_tracking();
     
     // Cleanup
     void cleanup();
@@ -10,8 +10,8 @@ BusCtrl::BusCtrl(sc_module_name name) :
     data_socket("data_socket")
 {
     // Bind target sockets
-    inst_socket.register_b_transport(this, &BusCtrl::b_transport);
-    inst_socket.register_get_direct_mem_ptr(this, &BusCtrl::get_direct_mem_ptr);
+    inst_socket.register_b_transport(this, &BusCtrl::inst_b_transport);
+    inst_socket.register_get_direct_mem_ptr(this, &BusCtrl::inst_get_direct_mem_ptr);
     inst_socket.register_transport_dbg(this, &BusCtrl::transport_dbg);
     
     data_socket.register_b_transport(this, &BusCtrl::b_transport);
@@ -21,31 +21,21 @@ BusCtrl::BusCtrl(sc_module_name name) :
     LOG_INFO("Flexible Bus Controller initialized");
 }
 
-void BusCtrl::add_device(const std::string& name, uint32_t base_address, uint32_t size, bool address_translation)
+void BusCtrl::add_device(const std::string& name, uint32_t base_address, uint32_t size,
+                         bool address_translation, bool dmi_allowed, bool executable)
 {
-    // Check for address conflicts
-    for (const auto& device : m_devices) {
-        uint32_t dev_end = device->base_address + device->size - 1;
-        uint32_t new_end = base_address + size - 1;
-        
-        if (!((base_address > dev_end) || (new_end < device->base_address))) {
-            std::stringstream ss;
-            ss << "Address conflict: Device '" << name << "' at 0x" << std::hex << base_address 
-               << " conflicts with existing device '" << device->name << "' at 0x" << device->base_address;
-            LOG_ERROR(ss.str());
-            return;
-        }
-    }
-    
     // Create new device mapping
-    auto device = std::make_unique<DeviceMapping>(name, base_address, size, address_translation);
+    auto device = std::make_unique<DeviceMapping>(name, base_address, size, address_translation, dmi_allowed);
+    if (!add_window(device.get(), base_address, size, executable)) {
+        return;
+    }
     
     // Create socket for this device
     std::string socket_name = name + "_socket";
     auto socket = std::make_unique<tlm_utils::simple_initiator_socket<BusCtrl>>(socket_name.c_str());
     
     device->socket = socket.get();
-    
+
     // Store device and socket
     size_t index = m_devices.size();
     m_device_index[name] = index;
@@ -59,9 +49,34 @@ void BusCtrl::add_device(const std::string& name, uint32_t base_address, uint32_
     if (!address_translation) {
         ss << " [no address translation]";
     }
+    if (dmi_allowed) {
+        ss << " [DMI]";
+    }
     LOG_INFO(ss.str());
 }
 
+bool BusCtrl::add_window(DeviceMapping* device, uint32_t base_address, uint32_t size, bool executable)
+{
+    // Check for address conflicts
+    uint32_t new_end = base_address + size - 1;
+    for (const auto& entry : m_decode_table) {
+        if (!((base_address > entry.last_address) || (new_end < entry.base_address))) {
+            std::stringstream ss;
+            ss << "Address conflict: Device '" << device->name << "' at 0x" << std::hex << base_address
+               << " conflicts with existing device '" << entry.device->name << "' at 0x" << entry.base_address;
+            LOG_ERROR(ss.str());
+            return false;
+        }
+    }
+
+    // Keep the decode table sorted by base address
+    DecodeEntry entry { base_address, new_end, device, executable };
+    auto pos = std::upper_bound(m_decode_table.begin(), m_decode_table.end(), base_address,
+                                [](uint32_t addr, const DecodeEntry& e) { return addr < e.base_address; });
+    m_decode_table.insert(pos, entry);
+    return true;
+}
+
 tlm_utils::simple_initiator_socket<BusCtrl>* BusCtrl::get_device_socket(const std::string& name)
 {
     auto it = m_device_index.find(name);
@@ -76,34 +91,42 @@ void BusCtrl::print_memory_map() const
 {
     LOG_INFO("=== Memory Map ===");
     
-    // Sort devices by base address for display
-    std::vector<const DeviceMapping*> sorted_devices;
-    for (const auto& device : m_devices) {
-        sorted_devices.push_back(device.get());
-    }
-    
-    std::sort(sorted_devices.begin(), sorted_devices.end(), 
-              [](const DeviceMapping* a, const DeviceMapping* b) {
-                  return a->base_address < b->base_address;
-              });
-    
-    for (const auto* device : sorted_devices) {
+    // The decode table is already sorted by base address
+    for (const auto& entry : m_decode_table) {
+        const DeviceMapping* device = entry.device;
         std::stringstream ss;
-        ss << "0x" << std::hex << std::setfill('0') << std::setw(8) << device->base_address 
-           << " - 0x" << std::setw(8) << (device->base_address + device->size - 1)
-           << " : " << device->name << " (size: 0x" << std::setw(4) << device->size << ")";
+        ss << "0x" << std::hex << std::setfill('0') << std::setw(8) << entry.base_address 
+           << " - 0x" << std::setw(8) << entry.last_address
+           << " : " << device->name << " (size: 0x" << std::setw(4)
+           << (static_cast<uint64_t>(entry.last_address) - entry.base_address + 1) << ")";
         if (!device->address_translation) {
             ss << " [no translation]";
         }
+        if (device->dmi_allowed) {
+            ss << " [DMI]";
+        }
+        if (!entry.executable) {
+            ss << " [no exec]";
+        }
         LOG_INFO(ss.str());
     }
     LOG_INFO("==================");
 }
 
 // Pre-defined device helpers
-void BusCtrl::add_memory(uint32_t base, uint32_t size) 
+void BusCtrl::add_memory(uint32_t base, uint32_t size, bool executable) 
 {
-    add_device("memory", base, size, false);  // Memory typically doesn't need address translation
+    auto it = m_device_index.find("memory");
+    if (it != m_device_index.end()) {
+        if (add_window(m_devices[it->second].get(), base, size, executable)) {
+            std::stringstream ss;
+            ss << "Added memory window at address range 0x" << std::hex << std::setfill('0')
+               << std::setw(8) << base << " - 0x" << std::setw(8) << (base + size - 1);
+            LOG_INFO(ss.str());
+        }
+        return;
+    }
+    add_device("memory", base, size, false, true, executable);  // Memory typically doesn't need address translation; DMI capable
 }
 
 void BusCtrl::add_trace_peripheral(uint32_t base, uint32_t size)
@@ -144,9 +167,32 @@ void BusCtrl::add_i2c(const std::string& name, uint32_t base, uint32_t size)
 void BusCtrl::b_transport(tlm_generic_payload& trans, sc_time& delay)
 {
     uint32_t address = trans.get_address();
-    DeviceMapping* device = decode_address(address);
+    const DecodeEntry* entry = decode_address(address);
     
-    route_transaction(trans, delay, device);
+    route_transaction(trans, delay, entry);
+}
+
+void BusCtrl::inst_b_transport(tlm_generic_payload& trans, sc_time& delay)
+{
+    uint32_t address = trans.get_address();
+    const DecodeEntry* entry = decode_address(address);
+    if (entry != nullptr && !entry->executable) {
+        std::stringstream ss;
+        ss << "Instruction fetch from non-executable address 0x" << std::hex << address;
+        LOG_WARNING(ss.str());
+        trans.set_response_status(TLM_COMMAND_ERROR_RESPONSE);
+        return;
+    }
+    route_transaction(trans, delay, entry);
+}
+
+bool BusCtrl::inst_get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data)
+{
+    const DecodeEntry* entry = decode_address(trans.get_address());
+    if (entry != nullptr && !entry->executable) {
+        return false;
+    }
+    return get_direct_mem_ptr(trans, dmi_data);
 }
 
 tlm_sync_enum BusCtrl::nb_transport_fw(tlm_generic_payload& trans, tlm_phase& phase, sc_time& delay)
@@ -156,21 +202,21 @@ tlm_sync_enum BusCtrl::nb_transport_fw(tlm_generic_payload& trans, tlm_phase& ph
     return TLM_COMPLETED;
 }
 
-BusCtrl::DeviceMapping* BusCtrl::decode_address(uint32_t address)
+const BusCtrl::DecodeEntry* BusCtrl::decode_address(uint32_t address) const
 {
-    for (auto& device : m_devices) {
-        if (address >= device->base_address && 
-            address < device->base_address + device->size) {
-            return device.get();
-        }
+    // Find the last range starting at or below the address
+    auto it = std::upper_bound(m_decode_table.begin(), m_decode_table.end(), address,
+                               [](uint32_t addr, const DecodeEntry& e) { return addr < e.base_address; });
+    if (it == m_decode_table.begin()) {
+        return nullptr;  // Invalid address
     }
-    
-    return nullptr;  // Invalid address
+    --it;
+    return (address <= it->last_address) ? &*it : nullptr;
 }
 
-void BusCtrl::route_transaction(tlm_generic_payload& trans, sc_time& delay, DeviceMapping* device)
+void BusCtrl::route_transaction(tlm_generic_payload& trans, sc_time& delay, const DecodeEntry* entry)
 {
-    if (device == nullptr) {
+    if (entry == nullptr) {
         std::stringstream ss;
         ss << "Invalid address access: 0x" << std::hex << trans.get_address();
         LOG_WARNING(ss.str());
@@ -182,8 +228,9 @@ void BusCtrl::route_transaction(tlm_generic_payload& trans, sc_time& delay, Devi
     uint32_t original_address = trans.get_address();
     
     // Apply address translation if needed
+    DeviceMapping* device = entry->device;
     if (device->address_translation) {
-        trans.set_address(original_address - device->base_address);
+        trans.set_address(original_address - entry->base_address);
     }
     
     // Forward transaction to appropriate device
@@ -196,31 +243,56 @@ void BusCtrl::route_transaction(tlm_generic_payload& trans, sc_time& delay, Devi
 bool BusCtrl::get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data)
 {
     uint32_t address = trans.get_address();
-    DeviceMapping* device = decode_address(address);
+    const DecodeEntry* entry = decode_address(address);
     
-    if (device != nullptr && device->name == "memory") {
-        // Only allow DMI for memory
-        return (*device->socket)->get_direct_mem_ptr(trans, dmi_data);
+    if (entry == nullptr || !entry->device->dmi_allowed) {
+        return false;  // No DMI for peripherals
     }
-    
-    return false;  // No DMI for peripherals
+
+    DeviceMapping* device = entry->device;
+    if (device->address_translation) {
+        trans.set_address(address - entry->base_address);
+    }
+    bool granted = (*device->socket)->get_direct_mem_ptr(trans, dmi_data);
+    trans.set_address(address);
+
+    if (granted) {
+        // Map the granted range back to bus addresses and clip it to the device window
+        uint64_t start = dmi_data.get_start_address();
+        uint64_t end = dmi_data.get_end_address();
+        if (device->address_translation) {
+            start += entry->base_address;
+            end += entry->base_address;
+        }
+        if (start < entry->base_address) {
+            dmi_data.set_dmi_ptr(dmi_data.get_dmi_ptr() + (entry->base_address - start));
+            start = entry->base_address;
+        }
+        if (end > entry->last_address) {
+            end = entry->last_address;
+        }
+        dmi_data.set_start_address(start);
+        dmi_data.set_end_address(end);
+    }
+    return granted;
 }
 
 unsigned int BusCtrl::transport_dbg(tlm_generic_payload& trans)
 {
     uint32_t address = trans.get_address();
-    DeviceMapping* device = decode_address(address);
+    const DecodeEntry* entry = decode_address(address);
     
-    if (device == nullptr) {
+    if (entry == nullptr) {
         return 0;
     }
+    DeviceMapping* device = entry->device;
     
     // Store original address for restoration
     uint32_t original_address = trans.get_address();
     
     // Apply address translation if needed
     if (device->address_translation) {
-        trans.set_address(original_address - device->base_address);
+        trans.set_address(original_address - entry->base_address);
     }
     
     // Forward debug transaction
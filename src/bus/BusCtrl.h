@@ -27,9 +27,10 @@ public:
         uint32_t size;
         tlm_utils::simple_initiator_socket<BusCtrl>* socket;
         bool address_translation;  // true if address should be adjusted to 0-based
+        bool dmi_allowed;          // true if the device may grant direct memory access
         
-        DeviceMapping(const std::string& n, uint32_t base, uint32_t sz, bool addr_trans = true) 
-            : name(n), base_address(base), size(sz), socket(nullptr), address_translation(addr_trans) {}
+        DeviceMapping(const std::string& n, uint32_t base, uint32_t sz, bool addr_trans = true, bool dmi = false) 
+            : name(n), base_address(base), size(sz), socket(nullptr), address_translation(addr_trans), dmi_allowed(dmi) {}
     };
 
     // Constructor
@@ -37,12 +38,16 @@ public:
     BusCtrl(sc_module_name name);
     
     // Device management methods
-    void add_device(const std::string& name, uint32_t base_address, uint32_t size, bool address_translation = true);
+    void add_device(const std::string& name, uint32_t base_address, uint32_t size,
+                    bool address_translation = true, bool dmi_allowed = false, bool executable = true);
     tlm_utils::simple_initiator_socket<BusCtrl>* get_device_socket(const std::string& name);
     void print_memory_map() const;
     
     // Pre-defined device helpers
-    void add_memory(uint32_t base = 0x00000000, uint32_t size = 0x40000000);
+    // Memory may be called once per memory region; later calls add another
+    // address window onto the same memory device. Instruction fetches from a
+    // window that is not executable fail and get no DMI.
+    void add_memory(uint32_t base = 0x00000000, uint32_t size = 0x40000000, bool executable = true);
     void add_trace_peripheral(uint32_t base = 0x40000000, uint32_t size = 0x00004000);
     void add_nvic(uint32_t base = 0xE000E000, uint32_t size = 0x00001000);
     void add_uart(const std::string& name, uint32_t base, uint32_t size = 0x1000);
@@ -57,15 +62,32 @@ public:
     virtual bool get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data);
     virtual unsigned int transport_dbg(tlm_generic_payload& trans);
 
+    // Instruction bus: as above, refusing non-executable windows
+    void inst_b_transport(tlm_generic_payload& trans, sc_time& delay);
+    bool inst_get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data);
+
 private:
     // Device storage
     std::vector<std::unique_ptr<DeviceMapping>> m_devices;
     std::map<std::string, size_t> m_device_index;  // name -> index in m_devices
     std::vector<std::unique_ptr<tlm_utils::simple_initiator_socket<BusCtrl>>> m_sockets;
+
+    // Decode table: non-overlapping address windows sorted by base address.
+    // A device has one window, or several for memory; translated addresses
+    // are relative to the window base.
+    struct DecodeEntry {
+        uint32_t base_address;
+        uint32_t last_address;     // Inclusive, so a range may end at 0xFFFFFFFF
+        DeviceMapping* device;
+        bool executable;           // Instruction fetches allowed
+    };
+    std::vector<DecodeEntry> m_decode_table;
     
-    // Address decoding
-    DeviceMapping* decode_address(uint32_t address);
-    void route_transaction(tlm_generic_payload& trans, sc_time& delay, DeviceMapping* device);
+    // Insert a window into m_decode_table; false on overlap with another window
+    bool add_window(DeviceMapping* device, uint32_t base_address, uint32_t size, bool executable = true);
+    // Address decoding (binary search over m_decode_table)
+    const DecodeEntry* decode_address(uint32_t address) const;
+    void route_transaction(tlm_generic_payload& trans, sc_time& delay, const DecodeEntry* entry);
 };
 
 #endif // BUSCTRL_H
\ No newline at end of file
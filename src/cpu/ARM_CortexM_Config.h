@@ -137,21 +137,97 @@
     #define HAS_MPU 1
 #endif
 
+// Instruction timing in core cycles, from the TRM instruction timing tables.
+// Taken branches cost CYCLES_BRANCH_TAKEN in total (1 + pipeline refill),
+// loads into PC add CYCLES_LOAD_PC_REFILL, LDM/STM/PUSH/POP cost 1 + N.
+// Divides terminate early: CYCLES_DIVIDE_MIN..CYCLES_DIVIDE_MAX.
+#if ARM_CORE_TYPE == CORTEX_M0
+    #define CYCLES_LOAD                2
+    #define CYCLES_STORE               2
+    #define CYCLES_MULTIPLY            1   // Fast multiplier option (32 with the small one)
+    #define CYCLES_MULTIPLY_ACC        1
+    #define CYCLES_LONG_MULTIPLY       1
+    #define CYCLES_DIVIDE_MIN          2
+    #define CYCLES_DIVIDE_MAX          12
+    #define CYCLES_BRANCH_TAKEN        3   // 3-stage pipeline
+    #define CYCLES_BL                  4
+    #define CYCLES_LOAD_PC_REFILL      3   // POP {pc}: 4 + N
+    #define CYCLES_BARRIER             4
+    #define CYCLES_SYSTEM_REGISTER     4   // MSR / MRS
+    #define CYCLES_EXCEPTION_ENTRY     16
+    #define CYCLES_EXCEPTION_RETURN    16
+#elif ARM_CORE_TYPE == CORTEX_M0_PLUS
+    #define CYCLES_LOAD                2
+    #define CYCLES_STORE               2
+    #define CYCLES_MULTIPLY            1   // Fast multiplier option (32 with the small one)
+    #define CYCLES_MULTIPLY_ACC        1
+    #define CYCLES_LONG_MULTIPLY       1
+    #define CYCLES_DIVIDE_MIN          2
+    #define CYCLES_DIVIDE_MAX          12
+    #define CYCLES_BRANCH_TAKEN        2   // 2-stage pipeline
+    #define CYCLES_BL                  3
+    #define CYCLES_LOAD_PC_REFILL      2   // POP {pc}: 3 + N
+    #define CYCLES_BARRIER             3
+    #define CYCLES_SYSTEM_REGISTER     3
+    #define CYCLES_EXCEPTION_ENTRY     15
+    #define CYCLES_EXCEPTION_RETURN    15
+#elif ARM_CORE_TYPE == CORTEX_M3
+    #define CYCLES_LOAD                2
+    #define CYCLES_STORE               2
+    #define CYCLES_MULTIPLY            1
+    #define CYCLES_MULTIPLY_ACC        2
+    #define CYCLES_LONG_MULTIPLY       4   // 3..5, early termination not modeled
+    #define CYCLES_DIVIDE_MIN          2
+    #define CYCLES_DIVIDE_MAX          12
+    #define CYCLES_BRANCH_TAKEN        3   // 1 + P, P = 1..3
+    #define CYCLES_BL                  3
+    #define CYCLES_LOAD_PC_REFILL      2
+    #define CYCLES_BARRIER             2
+    #define CYCLES_SYSTEM_REGISTER     2
+    #define CYCLES_EXCEPTION_ENTRY     12
+    #define CYCLES_EXCEPTION_RETURN    10
+#else
+    // Cortex-M4 (single-cycle MAC); also used for M7/M33/M55
+    #define CYCLES_LOAD                2
+    #define CYCLES_STORE               2
+    #define CYCLES_MULTIPLY            1
+    #define CYCLES_MULTIPLY_ACC        1
+    #define CYCLES_LONG_MULTIPLY       1
+    #define CYCLES_DIVIDE_MIN          2
+    #define CYCLES_DIVIDE_MAX          12
+    #define CYCLES_BRANCH_TAKEN        3   // 1 + P, P = 1..3
+    #define CYCLES_BL                  3
+    #define CYCLES_LOAD_PC_REFILL      2
+    #define CYCLES_BARRIER             2
+    #define CYCLES_SYSTEM_REGISTER     2
+    #define CYCLES_EXCEPTION_ENTRY     12
+    #define CYCLES_EXCEPTION_RETURN    10
+#endif
+
 // Debug macros for build-time information
+// ARM_CORE_NAMESPACE holds this core's decoder, executor and CPU model so
+// several core configurations can be linked into one simulator binary
 #if ARM_CORE_TYPE == CORTEX_M0
     #define ARM_CORE_NAME "Cortex-M0"
+    #define ARM_CORE_NAMESPACE cortex_m0
 #elif ARM_CORE_TYPE == CORTEX_M0_PLUS
     #define ARM_CORE_NAME "Cortex-M0+"
+    #define ARM_CORE_NAMESPACE cortex_m0plus
 #elif ARM_CORE_TYPE == CORTEX_M3
     #define ARM_CORE_NAME "Cortex-M3"
+    #define ARM_CORE_NAMESPACE cortex_m3
 #elif ARM_CORE_TYPE == CORTEX_M4
     #define ARM_CORE_NAME "Cortex-M4"
+    #define ARM_CORE_NAMESPACE cortex_m4
 #elif ARM_CORE_TYPE == CORTEX_M7
     #define ARM_CORE_NAME "Cortex-M7"
+    #define ARM_CORE_NAMESPACE cortex_m7
 #elif ARM_CORE_TYPE == CORTEX_M33
     #define ARM_CORE_NAME "Cortex-M33"
+    #define ARM_CORE_NAMESPACE cortex_m33
 #elif ARM_CORE_TYPE == CORTEX_M55
     #define ARM_CORE_NAME "Cortex-M55"
+    #define ARM_CORE_NAMESPACE cortex_m55
 #endif
 
 #if ARM_ARCH_VERSION == ARMV6_M
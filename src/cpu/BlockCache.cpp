@@ -0,0 +1,96 @@
+#include "BlockCache.h"
+
+namespace ARM_CORE_NAMESPACE {
+
+void TranslatedBlock::chain(uint32_t pc, TranslatedBlock* block)
+{
+    for (int i = 0; i < MAX_SUCCESSORS; i++) {
+        if (!successor[i] || successor_pc[i] == pc) {
+            successor_pc[i] = pc;
+            successor[i] = block;
+            return;
+        }
+    }
+    // Both slots taken (indirect branch with many targets): keep the most recent
+    successor_pc[MAX_SUCCESSORS - 1] = pc;
+    successor[MAX_SUCCESSORS - 1] = block;
+}
+
+BlockCache::BlockCache() :
+    m_lo(UINT64_MAX),
+    m_hi(0)
+{
+}
+
+TranslatedBlock* BlockCache::insert(std::unique_ptr<TranslatedBlock> block)
+{
+    if (block->start_pc < m_lo) m_lo = block->start_pc;
+    if (block->end_pc > m_hi) m_hi = block->end_pc;
+
+    TranslatedBlock* raw = block.get();
+    m_blocks[block->start_pc] = std::move(block);
+    return raw;
+}
+
+void BlockCache::flush()
+{
+    m_blocks.clear();
+    m_lo = UINT64_MAX;
+    m_hi = 0;
+}
+
+bool BlockCache::ends_block(const InstructionFields& fields)
+{
+    // Anything writing the PC directly (MOV/ADD PC, LDR PC, ...)
+    if (fields.rd == 15) {
+        return true;
+    }
+
+    switch (fields.type) {
+        case INST_UNKNOWN:
+        case INST_UNDEFINED:
+        case INST_T16_B_COND:
+        case INST_T16_B:
+        case INST_T16_BX:
+        case INST_T16_SVC:
+        case INST_T16_BKPT:
+        case INST_T16_WFI:
+        case INST_T16_WFE:
+        case INST_T16_CPS:
+#if HAS_BLX_REGISTER
+        case INST_T16_BLX:
+#endif
+#if SUPPORTS_ARMV7_M
+        case INST_T16_CBZ:
+        case INST_T16_CBNZ:
+        case INST_T32_CBZ:
+        case INST_T32_CBNZ:
+        case INST_T32_TBB:
+        case INST_T32_TBH:
+        case INST_T32_WFI:
+        case INST_T32_WFE:
+#endif
+#if HAS_T32_BL
+        case INST_T32_B:
+        case INST_T32_B_COND:
+        case INST_T32_BL:
+#endif
+#if HAS_SYSTEM_REGISTERS
+        case INST_T32_MSR:
+#endif
+            return true;
+
+        // POP {.., pc} / LDM with PC in the list, including EXC_RETURN
+        case INST_T16_POP:
+#if SUPPORTS_ARMV7_M
+        case INST_T32_LDMIA:
+        case INST_T32_LDMDB:
+#endif
+            return (fields.reg_list & 0x8000) != 0;
+
+        default:
+            return false;
+    }
+}
+
+} // namespace ARM_CORE_NAMESPACE
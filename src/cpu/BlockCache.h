@@ -0,0 +1,87 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Instruction.h"
+#include "Execute.h"
+
+namespace ARM_CORE_NAMESPACE {
+
+// One pre-decoded instruction inside a translated block
+struct BlockInstruction {
+    InstructionFields fields;
+    Execute::Handler handler; // Resolved at translation
+    uint32_t pc;
+    uint8_t length;      // 2 or 4 bytes
+    uint8_t cycles;      // CycleModel::base_cycles, fixed at translation
+};
+
+// Straight-line run of Thumb instructions ending at a control-flow change
+// (branch, BX, POP {pc}, exception return, SVC, ...). Successor blocks are
+// linked by pointer once the target has been observed at run time.
+struct TranslatedBlock {
+    uint32_t start_pc;
+    uint32_t end_pc;     // Address after the last instruction
+    std::vector<BlockInstruction> instructions;
+
+    // Chained successors: taken / fall-through targets seen so far
+    static constexpr int MAX_SUCCESSORS = 2;
+    uint32_t successor_pc[MAX_SUCCESSORS] { 0, 0 };
+    TranslatedBlock* successor[MAX_SUCCESSORS] { nullptr, nullptr };
+
+    // Index of the first instruction with a GDB breakpoint (size() if none),
+    // valid while the breakpoint generation matches
+    uint32_t breakpoint_generation { ~0u };
+    uint32_t breakpoint_index { 0 };
+
+    TranslatedBlock* find_successor(uint32_t pc) const {
+        for (int i = 0; i < MAX_SUCCESSORS; i++) {
+            if (successor[i] && successor_pc[i] == pc) return successor[i];
+        }
+        return nullptr;
+    }
+    void chain(uint32_t pc, TranslatedBlock* block);
+};
+
+// Owner of all translated blocks, keyed by start PC
+class BlockCache
+{
+public:
+    // Maximum number of instructions in one block
+    static constexpr size_t MAX_BLOCK_INSTRUCTIONS = 64;
+
+    BlockCache();
+
+    TranslatedBlock* lookup(uint32_t pc) const {
+        auto it = m_blocks.find(pc);
+        return it != m_blocks.end() ? it->second.get() : nullptr;
+    }
+
+    // Take ownership of a freshly translated block
+    TranslatedBlock* insert(std::unique_ptr<TranslatedBlock> block);
+
+    // True if [address, address + size) overlaps code of any translated block
+    bool overlaps(uint32_t address, uint32_t size) const {
+        return m_lo < m_hi && static_cast<uint64_t>(address) + size > m_lo && address < m_hi;
+    }
+
+    // Drop all blocks (chain pointers go with them)
+    void flush();
+
+    // True if the instruction must terminate a block
+    static bool ends_block(const InstructionFields& fields);
+
+private:
+    std::unordered_map<uint32_t, std::unique_ptr<TranslatedBlock>> m_blocks;
+
+    // Address range [m_lo, m_hi) covered by translated code since the last flush
+    uint64_t m_lo;
+    uint64_t m_hi;
+};
+
+} // namespace ARM_CORE_NAMESPACE
+
+#endif // BLOCK_CACHE_H
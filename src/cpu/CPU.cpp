@@ -3,15 +3,44 @@
 #include "Performance.h"
 #include "Log.h"
 #include "GDBServer.h"
+#include "Checkpoint.h"
+#include "SimulationControl.h"
+#include "Profiler.h"
+#include "InstructionTrace.h"
 #include <sstream>
 #include <stdexcept>
 #include <cstring>
 
+namespace ARM_CORE_NAMESPACE {
+
+// Call/return classification of a taken control transfer, for the profiler
+static Profiler::Transfer profile_transfer(const InstructionFields& fields)
+{
+    switch (fields.type) {
+#if HAS_T32_BL
+        case INST_T32_BL:
+#endif
+#if HAS_BLX_REGISTER
+        case INST_T16_BLX:
+#endif
+            return Profiler::TRANSFER_CALL;
+        case INST_T16_BX:
+            return fields.rm == 14 ? Profiler::TRANSFER_RETURN : Profiler::TRANSFER_NONE;
+        case INST_T16_POP:
+            return (fields.reg_list & 0x8000) ? Profiler::TRANSFER_RETURN : Profiler::TRANSFER_NONE;
+#if SUPPORTS_ARMV7_M
+        case INST_T32_LDMIA:
+            return (fields.rn == 13 && (fields.reg_list & 0x8000)) ? Profiler::TRANSFER_RETURN : Profiler::TRANSFER_NONE;
+        case INST_T32_LDR_PRE_POST:
+            return (fields.rn == 13 && fields.rd == 15) ? Profiler::TRANSFER_RETURN : Profiler::TRANSFER_NONE;
+#endif
+        default:
+            return Profiler::TRANSFER_NONE;
+    }
+}
+
 CPU::CPU(sc_module_name name) : 
-    sc_module(name),
-    inst_bus("inst_bus"),
-    data_bus("data_bus"),
-    irq_line("irq_line"),
+    CPUCore(name),
     m_irq_pending(false),
     m_pc(0),
     m_nmi_pending(false),
@@ -20,21 +49,35 @@ CPU::CPU(sc_module_name name) :
     m_hardfault_pending(false),
     m_svc_pending(false),
     m_pending_external_exception(0),
+    m_entry_point(0),
+    m_event_register(false),
     m_debug_mode(false),
     m_single_step(false),
     m_debug_paused(false),
-    m_gdb_server(nullptr)
+    m_gdb_server(nullptr),
+    m_engine(ENGINE_INTERPRETER),
+    m_prev_block(nullptr),
+    m_blocks_stale(false),
+    m_block_exit(false),
+    m_stop_time(SC_ZERO_TIME),
+    m_resume_time(SC_ZERO_TIME),
+    m_restored(false),
+    m_max_instructions(0),
+    m_cycle_time(1, SC_NS),
+    m_flash_wait_states(0),
+    m_extra_cycles(0),
+    m_last_fetch_word(0xFFFFFFFFu),
+    m_block_cycles(0),
+    m_block_fetches(0),
+    m_profiler(nullptr),
+    m_inst_trace(nullptr)
 {
     // Initialize sub-modules
     m_registers = new Registers("registers");
     m_instruction = new Instruction("instruction");
     m_execute = new Execute("execute", m_registers);
     m_execute->set_cpu(this);
-    
-    // Bind IRQ socket
-    irq_line.register_b_transport(this, &CPU::b_transport);
-    irq_line.register_get_direct_mem_ptr(this, &CPU::get_direct_mem_ptr);
-    irq_line.register_transport_dbg(this, &CPU::transport_dbg);
+    m_execute->set_watchpoints(&m_watchpoints);
     
     // Start CPU thread
     SC_THREAD(cpu_thread);
@@ -44,17 +87,35 @@ CPU::CPU(sc_module_name name) :
 
 void CPU::cpu_thread()
 {
+    // A restored checkpoint continues at its own timestamp
+    if (m_resume_time != SC_ZERO_TIME) {
+        wait(m_resume_time);
+    }
+
+    // Pick up the global quantum configured during elaboration
+    m_quantum_keeper.reset();
+
     // Perform ARM M-series reset with vector table initialization
-    if (m_pc == 0) {  // Only on first start
+    if (!m_restored && m_pc == 0) {  // Only on first start
         reset_from_vector_table();
     }
     
     while (true) {
         try {
+            // Program exit, instruction limit or requested stop point (checkpoint):
+            // end on an instruction boundary with local time synchronized
+            if (should_stop()) {
+                sync_time();
+                sc_stop();
+                break;
+            }
+
             // Debug mode handling - wait only when we need to pause
             if (m_debug_mode && m_gdb_server) {
                 // Only wait when explicitly paused (not during single-step)
                 if (m_debug_paused) {
+                    // No breakpoint lookup is in flight while stopped
+                    m_breakpoints.reclaim();
                     m_gdb_server->wait_for_continue();
                     m_debug_paused = false; // Clear pause flag after continuing
                 }
@@ -67,6 +128,11 @@ void CPU::cpu_thread()
             
             // Check for pending exceptions (in priority order)
             check_pending_exceptions();
+
+            // Stop in the handler if stacking the frame hit a watchpoint
+            if (report_watchpoint_hit()) {
+                continue;
+            }
             
             // Get current PC
             m_pc = m_registers->get_pc();
@@ -78,27 +144,81 @@ void CPU::cpu_thread()
                 m_debug_paused = true;
                 continue; // Go back to wait for continue
             }
+
+            // Block engine: run a whole translated block. Falls back to the interpreter
+            // below when no block can be built (non-DMI code), for GDB single steps
+            // and at breakpoints.
+            if (m_engine == ENGINE_BLOCK && !m_single_step && execute_block(m_pc)) {
+                report_watchpoint_hit();
+                continue;
+            }
             
-            // Fetch instruction (always fetch 32-bit to check for 32-bit instructions)
-            uint32_t instruction_data = fetch_instruction(m_pc);
-            
-            bool is_32bit = m_instruction->is_32bit_instruction(instruction_data);
+            sc_time profile_start = m_profiler ? m_quantum_keeper.get_current_time() : SC_ZERO_TIME;
+            InstructionFields fields;
+            Execute::Handler handler;
+            uint32_t length;
+            const DecodeCache::Entry* cached = m_decode_cache.lookup(m_pc);
+            if (cached) {
+                // Cached decode: charge the same fetch latency as the DMI path
+                fields = cached->fields;
+                handler = cached->handler;
+                length = cached->length;
+                consume_time(m_inst_dmi.get_read_latency());
+            } else {
+                // Fetch instruction (always fetch 32-bit to check for 32-bit instructions)
+                bool from_dmi = false;
+                uint32_t instruction_data = fetch_instruction(m_pc, &from_dmi);
+                
+                bool is_32bit = m_instruction->is_32bit_instruction(instruction_data);
+
+                // Decode instruction
+                fields = m_instruction->decode(instruction_data, is_32bit);
+                handler = Execute::handler_for(fields.type);
+                length = is_32bit ? 4 : 2;
+
+                // Only DMI-backed code is cached; its writes are the ones we can track
+                if (from_dmi) {
+                    m_decode_cache.insert(m_pc, fields, handler, length);
+                }
+            }
 
-            // Decode instruction
-            InstructionFields fields = m_instruction->decode(instruction_data, is_32bit);
+            if (m_inst_trace) {
+                m_inst_trace->instruction(m_pc, fields.opcode, length);
+            }
 
             // Execute instruction
-            bool pc_changed = m_execute->execute_instruction(fields, &data_bus);
+            bool pc_changed = m_execute->execute_instruction(fields, handler, &data_bus);
             
             // Update PC if not changed by instruction (branch, etc.)
             if (!pc_changed) {
                 // Increment PC based on instruction size
-                m_registers->set_pc(m_pc + (is_32bit ? 4 : 2));
+                m_registers->set_pc(m_pc + length);
+            }
+
+            // Charge the instruction's cycles: table cost, pipeline refill on a
+            // taken branch, data-dependent extras and flash wait states
+            uint32_t cycles = CycleModel::base_cycles(fields) + take_extra_cycles() +
+                              fetch_wait_cycles(m_pc, length);
+            if (pc_changed) {
+                cycles += CycleModel::refill_cycles(fields);
             }
+            consume_time(m_cycle_time * static_cast<double>(cycles));
             
             // Update performance counters
             Performance::getInstance().increment_instructions_executed();
-            
+
+            // Record before the debugger exits below so steps are profiled and
+            // calls/returns keep the shadow stack in sync
+            if (m_profiler) {
+                m_profiler->record(m_pc, to_cycles(m_quantum_keeper.get_current_time() - profile_start),
+                                   pc_changed ? profile_transfer(fields) : Profiler::TRANSFER_NONE,
+                                   m_registers->get_pc());
+            }
+
+            if (report_watchpoint_hit()) {
+                continue;
+            }
+
             // Handle single step in debug mode: send stop and pause
             // For branches, we want to stop at the target address, not the branch instruction itself
             if (m_debug_mode && m_single_step && m_gdb_server) {
@@ -109,10 +229,7 @@ void CPU::cpu_thread()
                 m_debug_paused = true; // ensure we pause on next loop
                 continue;
             }
-            
-            // Simulate one cycle delay
-            wait(1, SC_NS);
-            
+
         } catch (const std::exception& e) {
             LOG_ERROR("CPU exception: " + std::string(e.what()));
             break;
@@ -120,7 +237,7 @@ void CPU::cpu_thread()
     }
 }
 
-uint32_t CPU::fetch_instruction(uint32_t address)
+uint32_t CPU::fetch_instruction(uint32_t address, bool* from_dmi)
 {
     // DMI fast path
     if (m_inst_dmi_valid && address >= m_inst_dmi.get_start_address() && address + 3 <= m_inst_dmi.get_end_address()) {
@@ -128,7 +245,8 @@ uint32_t CPU::fetch_instruction(uint32_t address)
         uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_inst_dmi.get_start_address());
         uint32_t val = 0;
         std::memcpy(&val, base + off, sizeof(uint32_t));
-        wait(m_inst_dmi.get_read_latency());
+        consume_time(m_inst_dmi.get_read_latency());
+        if (from_dmi) *from_dmi = true;
         return val;
     }
 
@@ -145,7 +263,8 @@ uint32_t CPU::fetch_instruction(uint32_t address)
             uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_inst_dmi.get_start_address());
             uint32_t val = 0;
             std::memcpy(&val, base + off, sizeof(uint32_t));
-            wait(m_inst_dmi.get_read_latency());
+            consume_time(m_inst_dmi.get_read_latency());
+            if (from_dmi) *from_dmi = true;
             return val;
         }
     }
@@ -162,25 +281,223 @@ uint32_t CPU::fetch_instruction(uint32_t address)
     trans.set_byte_enable_ptr(nullptr);
     trans.set_dmi_allowed(true);
     trans.set_response_status(TLM_INCOMPLETE_RESPONSE);
+    sync_time();
     inst_bus->b_transport(trans, delay);
     if (trans.get_response_status() != TLM_OK_RESPONSE) {
         std::stringstream ss; ss << "Instruction fetch failed at address 0x" << std::hex << address;
         LOG_ERROR(ss.str());
         return 0;
     }
-    wait(delay);
+    consume_time(delay);
     return instruction;
 }
 
+bool CPU::peek_instruction(uint32_t address, uint32_t& data)
+{
+    if (!m_inst_dmi_valid || address < m_inst_dmi.get_start_address() || address + 3 > m_inst_dmi.get_end_address()) {
+        tlm_generic_payload dmi_req;
+        tlm_dmi dmi_data;
+        dmi_req.set_command(TLM_READ_COMMAND);
+        dmi_req.set_address(address);
+        if (!inst_bus->get_direct_mem_ptr(dmi_req, dmi_data)) {
+            return false;
+        }
+        m_inst_dmi = dmi_data;
+        m_inst_dmi_valid = true;
+        if (address < m_inst_dmi.get_start_address() || address + 3 > m_inst_dmi.get_end_address()) {
+            return false;
+        }
+    }
+
+    uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_inst_dmi.get_start_address());
+    std::memcpy(&data, m_inst_dmi.get_dmi_ptr() + off, sizeof(uint32_t));
+    return true;
+}
+
+TranslatedBlock* CPU::translate_block(uint32_t pc)
+{
+    std::unique_ptr<TranslatedBlock> block(new TranslatedBlock());
+    block->start_pc = pc;
+
+    uint32_t address = pc;
+    while (block->instructions.size() < BlockCache::MAX_BLOCK_INSTRUCTIONS) {
+        uint32_t instruction_data;
+        if (!peek_instruction(address, instruction_data)) {
+            break;
+        }
+
+        bool is_32bit = m_instruction->is_32bit_instruction(instruction_data);
+        BlockInstruction insn;
+        insn.fields = m_instruction->decode(instruction_data, is_32bit);
+        insn.handler = Execute::handler_for(insn.fields.type);
+        insn.pc = address;
+        insn.length = is_32bit ? 4 : 2;
+        insn.cycles = CycleModel::base_cycles(insn.fields);
+        block->instructions.push_back(insn);
+
+        address += insn.length;
+        if (BlockCache::ends_block(insn.fields)) {
+            break;
+        }
+    }
+
+    if (block->instructions.empty()) {
+        return nullptr;
+    }
+    block->end_pc = address;
+
+    if (LOG_ENABLED(LOG_TRACE)) {
+        std::stringstream ss;
+        ss << "Translated block 0x" << std::hex << block->start_pc << "-0x" << block->end_pc
+           << " (" << std::dec << block->instructions.size() << " instructions)";
+        LOG_TRACE(ss.str());
+    }
+
+    return m_block_cache.insert(std::move(block));
+}
+
+bool CPU::execute_block(uint32_t pc)
+{
+    if (m_blocks_stale) {
+        m_block_cache.flush();
+        m_prev_block = nullptr;
+        m_blocks_stale = false;
+    }
+
+    // Follow the chain from the previous block before falling back to the map
+    TranslatedBlock* block = m_prev_block ? m_prev_block->find_successor(pc) : nullptr;
+    if (!block) {
+        block = m_block_cache.lookup(pc);
+        if (!block) {
+            block = translate_block(pc);
+            if (!block) {
+                m_prev_block = nullptr;
+                return false;
+            }
+        }
+        if (m_prev_block) {
+            m_prev_block->chain(pc, block);
+        }
+    }
+
+    // Execute back-to-back; table cycles and fetch latency are accumulated and
+    // charged once at the end of the block
+    m_block_exit = false;
+    bool completed = true;
+    size_t count = block->instructions.size();
+    if (m_debug_mode) {
+        // Stop in front of the first breakpoint; blocks without one run as usual
+        uint32_t generation = m_breakpoints.generation();
+        if (block->breakpoint_generation != generation) {
+            block->breakpoint_index = count;
+            uint32_t address;
+            if (m_breakpoints.first_in_range(block->start_pc, block->end_pc, address)) {
+                for (size_t i = 0; i < count; i++) {
+                    if (m_breakpoints.contains(block->instructions[i].pc)) {
+                        block->breakpoint_index = static_cast<uint32_t>(i);
+                        break;
+                    }
+                }
+            }
+            block->breakpoint_generation = generation;
+        }
+        if (block->breakpoint_index < count) {
+            if (block->breakpoint_index == 0) {
+                m_prev_block = nullptr;
+                return false;
+            }
+            count = block->breakpoint_index;
+            completed = false;
+        }
+    }
+    if (m_max_instructions) {
+        // Do not run past the instruction limit inside a block
+        uint64_t remaining = m_max_instructions - Performance::getInstance().get_instructions_executed();
+        if (remaining < count) {
+            count = static_cast<size_t>(remaining);
+            completed = false;
+        }
+    }
+    const sc_time fetch_latency = m_inst_dmi.get_read_latency();
+    for (size_t i = 0; i < count; i++) {
+        const BlockInstruction& insn = block->instructions[i];
+        sc_time profile_start = SC_ZERO_TIME;
+        if (m_profiler) {
+            // Charge the earlier instructions so only this one is measured
+            charge_block_time();
+            profile_start = m_quantum_keeper.get_current_time();
+        }
+        if (m_inst_trace) {
+            m_inst_trace->instruction(insn.pc, insn.fields.opcode, insn.length);
+        }
+        bool pc_changed = m_execute->execute_instruction(insn.fields, insn.handler, &data_bus);
+        if (!pc_changed) {
+            m_registers->set_pc(insn.pc + insn.length);
+        }
+        uint32_t insn_cycles = insn.cycles + take_extra_cycles() + fetch_wait_cycles(insn.pc, insn.length);
+        if (pc_changed) {
+            insn_cycles += CycleModel::refill_cycles(insn.fields);
+        }
+        m_block_cycles += insn_cycles;
+        m_block_fetches++;
+        if (m_profiler) {
+            // Cycles and fetch are charged later; count them here per instruction
+            sc_time spent = m_quantum_keeper.get_current_time() - profile_start +
+                            m_cycle_time * static_cast<double>(insn_cycles) + fetch_latency;
+            m_profiler->record(insn.pc, to_cycles(spent),
+                               pc_changed ? profile_transfer(insn.fields) : Profiler::TRANSFER_NONE,
+                               m_registers->get_pc());
+        }
+        Performance::getInstance().increment_instructions_executed();
+
+        // Leave early on an unexpected PC write, pending exception, code modification,
+        // watchpoint hit or exit
+        if ((pc_changed && i + 1 < count) || m_block_exit || SimulationControl::exit_requested()) {
+            completed = false;
+            break;
+        }
+    }
+
+    m_prev_block = (completed && !m_blocks_stale) ? block : nullptr;
+    charge_block_time();
+    if (m_quantum_keeper.need_sync()) {
+        m_quantum_keeper.sync();
+    }
+    return true;
+}
+
+// A data watchpoint fired: stop after the accessing instruction
+bool CPU::report_watchpoint_hit()
+{
+    Watchpoints::Type watch_type;
+    uint32_t watch_address;
+    if (m_debug_mode && m_gdb_server && m_watchpoints.take_hit(watch_type, watch_address)) {
+        m_gdb_server->notify_watchpoint(watch_type, watch_address);
+        m_single_step = false;
+        m_debug_paused = true;
+        return true;
+    }
+    return false;
+}
+
+void CPU::set_instruction_trace(InstructionTrace* trace)
+{
+    m_inst_trace = trace;
+    m_execute->set_trace(trace);
+    m_registers->set_trace(trace);
+}
+
 uint32_t CPU::read_memory_word(uint32_t address)
 {
+    watch_word_access(address, false);
+
     // DMI fast path (data bus)
     if (m_data_dmi_valid && address >= m_data_dmi.get_start_address() && address + 3 <= m_data_dmi.get_end_address()) {
         auto base = m_data_dmi.get_dmi_ptr();
         uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
         uint32_t val = 0;
         std::memcpy(&val, base + off, sizeof(uint32_t));
-        wait(m_data_dmi.get_read_latency());
+        consume_time(m_data_dmi.get_read_latency());
         return val;
     }
 
@@ -197,7 +514,7 @@ uint32_t CPU::read_memory_word(uint32_t address)
             uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
             uint32_t val = 0;
             std::memcpy(&val, base + off, sizeof(uint32_t));
-            wait(m_data_dmi.get_read_latency());
+            consume_time(m_data_dmi.get_read_latency());
             return val;
         }
     }
@@ -214,13 +531,14 @@ uint32_t CPU::read_memory_word(uint32_t address)
     trans.set_byte_enable_ptr(nullptr);
     trans.set_dmi_allowed(true);
     trans.set_response_status(TLM_INCOMPLETE_RESPONSE);
+    sync_time();
     data_bus->b_transport(trans, delay);
     if (trans.get_response_status() != TLM_OK_RESPONSE) {
         std::stringstream ss; ss << "Memory read failed at address 0x" << std::hex << address;
         LOG_ERROR(ss.str());
         return 0;
     }
-    wait(delay);
+    consume_time(delay);
     return data;
 }
 
@@ -253,6 +571,13 @@ void CPU::reset_from_vector_table()
         ss << "Set initial PC from reset vector: 0x" << std::hex << reset_pc 
            << " (raw vector: 0x" << std::hex << reset_vector << ")";
         LOG_INFO(ss.str());
+    } else if (m_entry_point != 0) {
+        uint32_t entry_pc = m_entry_point & 0xFFFFFFFE;
+        m_registers->set_pc(entry_pc);
+        m_pc = entry_pc;
+        std::stringstream ss;
+        ss << "Reset vector is 0, starting at image entry point: 0x" << std::hex << entry_pc;
+        LOG_INFO(ss.str());
     } else {
         LOG_WARNING("Reset vector is 0, using default PC");
     }
@@ -275,6 +600,9 @@ void CPU::b_transport(tlm_generic_payload& trans, sc_time& delay)
 {
     // Handle exception signals from NVIC
     if (trans.get_command() == TLM_WRITE_COMMAND) {
+        m_block_exit = true;  // Take the exception at the next instruction boundary
+        m_event_register = true;  // Exceptions are WFE wake-up events too
+        m_wakeup.notify();
         uint32_t* data = reinterpret_cast<uint32_t*>(trans.get_data_ptr());
         uint32_t exception_type = *data;
         
@@ -327,6 +655,11 @@ unsigned int CPU::transport_dbg(tlm_generic_payload& trans)
 
 void CPU::check_pending_exceptions()
 {
+    // Bring local time in line with the kernel before taking an exception
+    if (has_pending_exception()) {
+        sync_time();
+    }
+
     // Check exceptions in priority order (ARM Cortex-M0 exception priorities)
     // NMI has highest priority (except Reset)
     if (m_nmi_pending) {
@@ -374,6 +707,7 @@ void CPU::check_pending_exceptions()
 void CPU::request_svc()
 {
     m_svc_pending = true;
+    m_block_exit = true;
 }
 
 bool CPU::try_exception_return(uint32_t exc_return)
@@ -442,6 +776,7 @@ bool CPU::try_exception_return(uint32_t exc_return)
 
     // Branch to restored PC (ensure Thumb bit handling) for both Thread and Handler returns
     m_registers->set_pc(pc & ~1u);
+    add_cycles(CYCLES_EXCEPTION_RETURN);
     LOG_INFO("Exception return performed to PC: 0x" + [] (uint32_t v){ std::stringstream ss; ss<<std::hex<<v; return ss.str(); }(pc));
     return true;
 }
@@ -449,6 +784,10 @@ bool CPU::try_exception_return(uint32_t exc_return)
 void CPU::handle_exception(ExceptionType exception_type)
 {
     LOG_INFO("Handling exception type: " + std::to_string(exception_type));
+    if (m_inst_trace) {
+        m_inst_trace->exception_entry(static_cast<uint32_t>(exception_type));
+    }
+    consume_time(m_cycle_time * static_cast<double>(CYCLES_EXCEPTION_ENTRY));
     
     // Save current context by pushing stack frame
     uint32_t return_address = m_registers->get_pc();
@@ -470,6 +809,9 @@ void CPU::handle_exception(ExceptionType exception_type)
         // Clear bit 0 (Thumb bit) for proper execution
         handler_address = handler_address & 0xFFFFFFFE;
         m_registers->set_pc(handler_address);
+        if (m_profiler) {
+            m_profiler->exception_entry(handler_address);
+        }
         std::stringstream ss; ss << "Jumping to exception handler at: 0x" << std::hex << handler_address;
         LOG_INFO(ss.str());
     } else {
@@ -549,13 +891,16 @@ void CPU::push_exception_stack_frame(uint32_t return_address)
 
 void CPU::write_memory_word(uint32_t address, uint32_t data)
 {
+    watch_word_access(address, true);
+
     // DMI fast path for writes
     if (m_data_dmi_valid && address >= m_data_dmi.get_start_address() && address + 3 <= m_data_dmi.get_end_address()) {
         if (m_data_dmi.is_write_allowed()) {
             auto base = m_data_dmi.get_dmi_ptr();
             uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
             std::memcpy(base + off, &data, sizeof(uint32_t));
-            wait(m_data_dmi.get_write_latency());
+            invalidate_decoded(address, sizeof(uint32_t));
+            consume_time(m_data_dmi.get_write_latency());
             return;
         }
     }
@@ -572,7 +917,8 @@ void CPU::write_memory_word(uint32_t address, uint32_t data)
             auto base = m_data_dmi.get_dmi_ptr();
             uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
             std::memcpy(base + off, &data, sizeof(uint32_t));
-            wait(m_data_dmi.get_write_latency());
+            invalidate_decoded(address, sizeof(uint32_t));
+            consume_time(m_data_dmi.get_write_latency());
             return;
         }
     }
@@ -588,11 +934,14 @@ void CPU::write_memory_word(uint32_t address, uint32_t data)
     trans.set_byte_enable_ptr(nullptr);
     trans.set_dmi_allowed(true);
     trans.set_response_status(TLM_INCOMPLETE_RESPONSE);
+    sync_time();
     data_bus->b_transport(trans, delay);
     if (trans.get_response_status() != TLM_OK_RESPONSE) {
         std::stringstream ss; ss << "Memory write failed at address: 0x" << std::hex << address;
         LOG_ERROR(ss.str());
+        return;
     }
+    invalidate_decoded(address, sizeof(uint32_t));
 }
 
 // Debug interface methods for GDB server
@@ -639,13 +988,129 @@ void CPU::write_memory_debug(uint32_t address, uint8_t data)
     if (trans.get_response_status() != TLM_OK_RESPONSE) {
         throw std::runtime_error("Debug memory write failed");
     }
+
+    // GDB may patch code (e.g. software breakpoints); drop stale decodes
+    invalidate_decoded(address, 1);
+}
+
+void CPU::save_state(CheckpointWriter& out) const
+{
+    m_registers->save_state(out);
+
+    out.section("CPU ");
+    out.put_u32(m_registers->get_pc());
+    out.put_u32(m_entry_point);
+    out.put_u8(m_irq_pending ? 1 : 0);
+    out.put_u8(m_nmi_pending ? 1 : 0);
+    out.put_u8(m_pendsv_pending ? 1 : 0);
+    out.put_u8(m_systick_pending ? 1 : 0);
+    out.put_u8(m_hardfault_pending ? 1 : 0);
+    out.put_u8(m_svc_pending ? 1 : 0);
+    out.put_u32(m_pending_external_exception);
 }
 
-bool CPU::check_breakpoint(uint32_t address) const
+bool CPU::restore_state(CheckpointReader& in, const sc_time& resume_time)
 {
-    // Check if there's a breakpoint at this address via GDB server
-    if (m_gdb_server) {
-        return m_gdb_server->has_breakpoint(address);
+    if (!m_registers->restore_state(in) || !in.section("CPU ")) {
+        return false;
     }
-    return false;
-}
\ No newline at end of file
+    m_pc = in.get_u32();
+    m_entry_point = in.get_u32();
+    m_irq_pending = in.get_u8() != 0;
+    m_nmi_pending = in.get_u8() != 0;
+    m_pendsv_pending = in.get_u8() != 0;
+    m_systick_pending = in.get_u8() != 0;
+    m_hardfault_pending = in.get_u8() != 0;
+    m_svc_pending = in.get_u8() != 0;
+    m_pending_external_exception = in.get_u32();
+    if (!in.ok()) {
+        return false;
+    }
+
+    // Memory is replaced wholesale: nothing decoded so far is trustworthy
+    m_decode_cache.flush();
+    m_block_cache.flush();
+    m_prev_block = nullptr;
+    m_inst_dmi_valid = false;
+    m_data_dmi_valid = false;
+
+    m_restored = true;
+    m_resume_time = resume_time;
+    return true;
+}
+
+void CPU::wait_for_interrupt()
+{
+    if (has_pending_exception()) {
+        return;  // Already something to take: WFI completes at once
+    }
+
+    sync_time();
+    if (m_stop_time > sc_time_stamp()) {
+        // Still honor a requested stop point while asleep
+        wait(m_stop_time - sc_time_stamp(), m_wakeup);
+    } else {
+        wait(m_wakeup);
+    }
+}
+
+void CPU::wait_for_event()
+{
+    if (m_event_register) {
+        m_event_register = false;
+        return;
+    }
+    wait_for_interrupt();
+    m_event_register = false;
+}
+
+bool CPU::should_stop() const
+{
+    if (SimulationControl::exit_requested()) {
+        return true;
+    }
+    if (m_max_instructions && Performance::getInstance().get_instructions_executed() >= m_max_instructions) {
+        SimulationControl::request_exit(124, "instruction limit reached");
+        return true;
+    }
+    return m_stop_time != SC_ZERO_TIME && m_quantum_keeper.get_current_time() >= m_stop_time;
+}
+
+void CPU::semihosting_call()
+{
+    // Semihosting operation numbers and reason codes (ARM semihosting spec)
+    const uint32_t SYS_EXIT = 0x18;
+    const uint32_t SYS_EXIT_EXTENDED = 0x20;
+    const uint32_t ADP_STOPPED_APPLICATION_EXIT = 0x20026;
+
+    uint32_t operation = m_registers->read_register(0);
+    uint32_t parameter = m_registers->read_register(1);
+
+    if (operation == SYS_EXIT) {
+        // AArch32 SYS_EXIT passes the reason code itself; there is no status
+        int code = (parameter == ADP_STOPPED_APPLICATION_EXIT) ? 0 : 1;
+        SimulationControl::request_exit(code, "semihosting SYS_EXIT");
+    } else if (operation == SYS_EXIT_EXTENDED) {
+        // Parameter block: { reason, subcode }; subcode is the exit status
+        uint32_t reason = read_memory_word(parameter);
+        uint32_t subcode = read_memory_word(parameter + 4);
+        int code = (reason == ADP_STOPPED_APPLICATION_EXIT) ? static_cast<int>(subcode) : 1;
+        SimulationControl::request_exit(code, "semihosting SYS_EXIT_EXTENDED");
+    } else {
+        std::stringstream ss;
+        ss << "Unsupported semihosting operation 0x" << std::hex << operation;
+        LOG_WARNING(ss.str());
+        m_registers->write_register(0, 0xFFFFFFFF);
+    }
+    m_block_exit = true;
+}
+
+static CPUCore* create_cpu(sc_module_name name)
+{
+    return new CPU(name);
+}
+
+// Makes this core selectable with --core
+static CPUCoreRegistration registration(ARM_CORE_NAME, create_cpu);
+
+} // namespace ARM_CORE_NAMESPACE
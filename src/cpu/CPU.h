@@ -5,16 +5,29 @@
 #include <tlm>
 #include <tlm_utils/simple_initiator_socket.h>
 #include <tlm_utils/simple_target_socket.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
 
+#include "CPUCore.h"
 #include "Registers.h"
 #include "Instruction.h"
-// Forward declare Execute to avoid circular header inclusion
-class Execute;
+#include "DecodeCache.h"
+#include "BlockCache.h"
+#include "CycleModel.h"
+#include "Watchpoints.h"
+#include "Breakpoints.h"
 class GDBServer;
+class CheckpointWriter;
+class CheckpointReader;
+class Profiler;
 
 using namespace sc_core;
 using namespace tlm;
 
+namespace ARM_CORE_NAMESPACE {
+
+// Forward declare Execute to avoid circular header inclusion
+class Execute;
+
 // ARM Cortex-M0 Exception Numbers
 enum ExceptionType {
     EXCEPTION_RESET = 1,
@@ -26,19 +39,24 @@ enum ExceptionType {
     EXCEPTION_IRQ0 = 16  // External interrupts start from 16
 };
 
-class CPU : public sc_module
+// CPU model of the core selected by ARM_CORE_TYPE for this compilation
+class CPU final : public CPUCore
 {
 public:
-    // TLM sockets
-    tlm_utils::simple_initiator_socket<CPU> inst_bus; // Instruction bus
-    tlm_utils::simple_initiator_socket<CPU> data_bus; // Data bus
-    tlm_utils::simple_target_socket<CPU> irq_line;    // IRQ line
-
     // Constructor
     SC_HAS_PROCESS(CPU);
     CPU(sc_module_name name);
     // Allow Execute to signal SVC
     void request_svc();
+    // Leave the current translated block after this instruction (watchpoint hit)
+    void request_block_exit() { m_block_exit = true; }
+    // ARM semihosting call (BKPT 0xAB): operation in R0, parameter in R1
+    void semihosting_call();
+    // Low-power hints: the CPU thread sleeps on m_wakeup until an exception
+    // is delivered instead of stepping through idle time
+    void wait_for_interrupt();
+    void wait_for_event();
+    void send_event() { m_event_register = true; }
     // Try to perform an exception return when branching to EXC_RETURN magic values
     // Returns true if an exception return was performed and PC was updated
     bool try_exception_return(uint32_t exc_return);
@@ -48,23 +66,89 @@ public:
 
     // Reset CPU with proper ARM M-series vector table initialization
     void reset_from_vector_table();
+    // Image entry point, used when the reset vector is empty
+    void set_entry_point(uint32_t entry) override { m_entry_point = entry; }
+
+    const char* core_name() const override { return ARM_CORE_NAME; }
+    const char* arch_name() const override { return ARM_ARCH_NAME; }
 
     // TLM-2 interface methods for IRQ
-    void b_transport(tlm_generic_payload& trans, sc_time& delay);
-    bool get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data);
-    unsigned int transport_dbg(tlm_generic_payload& trans);
+    void b_transport(tlm_generic_payload& trans, sc_time& delay) override;
+    bool get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data) override;
+    unsigned int transport_dbg(tlm_generic_payload& trans) override;
 
     // Debug interface for GDB server
-    Registers* get_registers() const { return m_registers; }
-    uint32_t read_memory_debug(uint32_t address);
-    void write_memory_debug(uint32_t address, uint8_t data);
-    void set_debug_mode(bool debug) { m_debug_mode = debug; }
-    bool is_debug_mode() const { return m_debug_mode; }
-    void set_single_step(bool step) { m_single_step = step; }
-    bool is_single_step() const { return m_single_step; }
-    void set_debug_paused(bool paused) { m_debug_paused = paused; }
-    bool check_breakpoint(uint32_t address) const;
-    void set_gdb_server(class GDBServer* gdb) { m_gdb_server = gdb; }
+    Registers* get_registers() const override { return m_registers; }
+    uint32_t read_memory_debug(uint32_t address) override;
+    void write_memory_debug(uint32_t address, uint8_t data) override;
+    void set_debug_mode(bool debug) override { m_debug_mode = debug; }
+    bool is_debug_mode() const override { return m_debug_mode; }
+    void set_single_step(bool step) override { m_single_step = step; }
+    bool is_single_step() const override { return m_single_step; }
+    void set_debug_paused(bool paused) override { m_debug_paused = paused; }
+    Watchpoints& get_watchpoints() override { return m_watchpoints; }
+    Breakpoints& get_breakpoints() override { return m_breakpoints; }
+    bool check_breakpoint(uint32_t address) const { return m_breakpoints.contains(address); }
+    void set_gdb_server(GDBServer* gdb) override { m_gdb_server = gdb; }
+
+    // Drop cached decodes overlapping a memory write (self-modifying code, GDB M packets)
+    void invalidate_decoded(uint32_t address, uint32_t size) {
+        m_decode_cache.invalidate(address, size);
+        if (m_block_cache.overlaps(address, size)) {
+            // Blocks may be executing; flush at the next block boundary
+            m_blocks_stale = true;
+            m_block_exit = true;
+        }
+    }
+
+    // Temporal decoupling: local time runs ahead of the kernel and is only
+    // synchronized at quantum boundaries, around peripheral accesses and
+    // before taking an exception. A zero quantum yields on every increment.
+    void consume_time(const sc_time& t) {
+        m_quantum_keeper.inc(t);
+        if (m_quantum_keeper.need_sync()) {
+            m_quantum_keeper.sync();
+        }
+    }
+    void sync_time() {
+        charge_block_time();
+        if (m_quantum_keeper.get_local_time() != SC_ZERO_TIME) {
+            m_quantum_keeper.sync();
+        }
+    }
+
+    // Cycle timing: instructions are charged in core cycles from CycleModel,
+    // converted to time with the core clock period
+    void set_clock_frequency(double hz) override { m_cycle_time = sc_time(1.0 / hz, SC_SEC); }
+    const sc_time& get_cycle_time() const override { return m_cycle_time; }
+    // Wait states added to every instruction fetch from flash (code region, below 0x20000000)
+    void set_flash_wait_states(uint32_t wait_states) override { m_flash_wait_states = wait_states; }
+    void add_flash_region(uint32_t base, uint32_t size) override {
+        if (size) {
+            m_flash_regions.push_back(FlashRegion{ base, base + (size - 1) });
+        }
+    }
+    // Data-dependent cycles on top of the table cost of the current instruction
+    void add_cycles(uint32_t cycles) { m_extra_cycles += cycles; }
+
+    // Execution engine selection
+    void set_engine(ExecutionEngine engine) override { m_engine = engine; }
+    ExecutionEngine get_engine() const override { return m_engine; }
+
+    // Checkpointing. The CPU stops the simulation on the first instruction
+    // boundary at or after the stop time, so a checkpoint never captures a
+    // half-executed instruction. A restored CPU skips the reset sequence and
+    // resumes at the checkpoint time.
+    void set_stop_time(const sc_time& t) override { m_stop_time = t; }
+    // Per-PC profiling (nullptr: off)
+    void set_profiler(Profiler* profiler) override { m_profiler = profiler; }
+    // Binary execution trace (nullptr: off)
+    void set_instruction_trace(InstructionTrace* trace) override;
+
+    // End the run with exit code 124 after this many instructions (0: no limit)
+    void set_max_instructions(uint64_t count) override { m_max_instructions = count; }
+    void save_state(CheckpointWriter& out) const override;
+    bool restore_state(CheckpointReader& in, const sc_time& resume_time) override;
 
 private:
     // Sub-modules
@@ -81,23 +165,110 @@ private:
     bool m_hardfault_pending;
     bool m_svc_pending;
     uint32_t m_pending_external_exception; // e.g., 16 + IRQ number when pending
+    uint32_t m_entry_point;
+    sc_event m_wakeup;        // Notified when an exception is delivered
+    bool m_event_register;    // WFE/SEV event latch
     
     // Debug state
     bool m_debug_mode;
     bool m_single_step;
     bool m_debug_paused;
     class GDBServer* m_gdb_server;
+    Watchpoints m_watchpoints;
+    Breakpoints m_breakpoints;
 
     // DMI caches
     bool m_inst_dmi_valid = false;
     bool m_data_dmi_valid = false;
     tlm_dmi m_inst_dmi;
     tlm_dmi m_data_dmi;
+
+    // Local time offset against the global quantum
+    tlm_utils::tlm_quantumkeeper m_quantum_keeper;
+
+    // Decoded instruction cache (filled only for DMI-backed code)
+    DecodeCache m_decode_cache;
+
+    // Block engine state
+    ExecutionEngine m_engine;
+    BlockCache m_block_cache;
+    TranslatedBlock* m_prev_block;  // Last completed block, for chaining
+    bool m_blocks_stale;            // Code under a block was written
+    bool m_block_exit;              // Leave the current block early (exception, code write)
+
+    // Checkpoint state
+    sc_time m_stop_time;    // Zero: run until the kernel stops
+    sc_time m_resume_time;  // Start time after a restore
+    bool m_restored;
+    uint64_t m_max_instructions;
+
+    // Cycle timing
+    sc_time m_cycle_time;          // Core clock period
+    uint32_t m_flash_wait_states;
+    struct FlashRegion {
+        uint32_t base;
+        uint32_t last;
+    };
+    std::vector<FlashRegion> m_flash_regions;  // From the memory map, usually one
+    uint32_t m_extra_cycles;       // Added by Execute / exception handling, taken per instruction
+    uint32_t m_last_fetch_word;    // Flash word of the previous fetch; sequential fetches hit the buffer
+    uint64_t m_block_cycles;       // Cycles and fetches of the running block not yet charged
+    uint64_t m_block_fetches;
+    uint32_t fetch_wait_cycles(uint32_t pc, uint32_t length) {
+        if (!m_flash_wait_states || !in_flash(pc)) {
+            return 0;
+        }
+        // One flash access per new 32-bit word fetched
+        uint32_t first = pc >> 2, last = (pc + length - 1) >> 2;
+        uint32_t accesses = (first != m_last_fetch_word) + (last != first);
+        m_last_fetch_word = last;
+        return accesses * m_flash_wait_states;
+    }
+    bool in_flash(uint32_t pc) const {
+        for (const FlashRegion& region : m_flash_regions) {
+            if (pc >= region.base && pc <= region.last) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // The block engine charges its instructions in one go; anything that looks
+    // at the time mid-block (peripheral access, WFI) charges them first
+    void charge_block_time() {
+        if (m_block_fetches) {
+            m_quantum_keeper.inc(m_cycle_time * static_cast<double>(m_block_cycles) +
+                                 m_inst_dmi.get_read_latency() * static_cast<double>(m_block_fetches));
+            m_block_cycles = 0;
+            m_block_fetches = 0;
+        }
+    }
+    uint32_t take_extra_cycles() {
+        uint32_t cycles = m_extra_cycles;
+        m_extra_cycles = 0;
+        return cycles;
+    }
+
+    Profiler* m_profiler;
+    InstructionTrace* m_inst_trace;
+    uint64_t to_cycles(const sc_time& t) const {
+        return static_cast<uint64_t>(t / m_cycle_time + 0.5);
+    }
     
     // Helper methods
-    uint32_t fetch_instruction(uint32_t address);
+    uint32_t fetch_instruction(uint32_t address, bool* from_dmi = nullptr);
+    bool peek_instruction(uint32_t address, uint32_t& data);  // DMI read without timing
+    TranslatedBlock* translate_block(uint32_t pc);
+    bool execute_block(uint32_t pc);
+    bool report_watchpoint_hit();
     uint32_t read_memory_word(uint32_t address);  // Helper to read from memory
     void write_memory_word(uint32_t address, uint32_t data);  // Helper to write to memory
+    // The core's own accesses (exception stacking and unstacking, vector
+    // reads) are checked against the watchpoints like instruction accesses
+    void watch_word_access(uint32_t address, bool write) {
+        if (m_watchpoints.armed() && m_watchpoints.check(address, sizeof(uint32_t), write)) {
+            m_block_exit = true;
+        }
+    }
     void handle_irq();
     
     // Exception handling methods
@@ -106,6 +277,13 @@ private:
     uint32_t get_exception_vector_address(ExceptionType exception_type);
     void push_exception_stack_frame(uint32_t return_address);
     void check_pending_exceptions();
+    bool should_stop() const;
+    bool has_pending_exception() const {
+        return m_nmi_pending || m_hardfault_pending || m_svc_pending || m_systick_pending ||
+               m_pendsv_pending || m_irq_pending;
+    }
 };
 
+} // namespace ARM_CORE_NAMESPACE
+
 #endif // CPU_H
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "CPUCore.h"
+#include <cctype>
+#include <map>
+
+namespace {
+
+// "Cortex-M0+", "cortex-m0plus", "CORTEX_M0_PLUS" and "m0+" -> "m0plus"
+std::string normalize_core_name(const std::string& name)
+{
+    std::string key;
+    for (char c : name) {
+        if (c == '+') {
+            key += "plus";
+        } else if (std::isalnum(static_cast<unsigned char>(c))) {
+            key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    if (key.compare(0, 6, "cortex") == 0) {
+        key.erase(0, 6);
+    }
+    return key;
+}
+
+struct RegisteredCore {
+    std::string name;
+    CPUCore::Factory factory;
+};
+
+// Function-local so registration from other translation units is order-safe
+std::map<std::string, RegisteredCore>& core_registry()
+{
+    static std::map<std::string, RegisteredCore> registry;
+    return registry;
+}
+
+} // namespace
+
+void CPUCore::register_core(const char* name, Factory factory)
+{
+    core_registry()[normalize_core_name(name)] = { name, factory };
+}
+
+CPUCore* CPUCore::create(const std::string& name, sc_module_name module_name)
+{
+    auto it = core_registry().find(normalize_core_name(name));
+    if (it == core_registry().end()) {
+        return nullptr;
+    }
+    return it->second.factory(module_name);
+}
+
+bool CPUCore::has_core(const std::string& name)
+{
+    return core_registry().count(normalize_core_name(name)) != 0;
+}
+
+std::vector<std::string> CPUCore::available_cores()
+{
+    std::vector<std::string> names;
+    for (const auto& entry : core_registry()) {
+        names.push_back(entry.second.name);
+    }
+    return names;
+}
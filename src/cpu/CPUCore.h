@@ -0,0 +1,117 @@
+#ifndef CPU_CORE_H
+#define CPU_CORE_H
+
+#include <systemc>
+#include <tlm>
+#include <tlm_utils/simple_initiator_socket.h>
+#include <tlm_utils/simple_target_socket.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
+#include <string>
+#include <vector>
+
+class Registers;
+class GDBServer;
+class CheckpointWriter;
+class CheckpointReader;
+class Profiler;
+class InstructionTrace;
+class Watchpoints;
+class Breakpoints;
+
+using namespace sc_core;
+using namespace tlm;
+
+// Instruction execution engine
+enum ExecutionEngine {
+    ENGINE_INTERPRETER = 0,  // One fetch/decode/execute per loop iteration (reference)
+    ENGINE_BLOCK             // Pre-decoded basic blocks, chained by pointer
+};
+
+// Core-independent face of a CPU model. The decoder, executor and CPU loop
+// are compiled once per core configuration (ARM_CortexM_Config.h), each into
+// its own namespace, so every core is a fully specialized engine; the
+// simulator picks one at startup by name and talks to it through this class.
+class CPUCore : public sc_module
+{
+public:
+    // TLM sockets
+    tlm_utils::simple_initiator_socket<CPUCore> inst_bus; // Instruction bus
+    tlm_utils::simple_initiator_socket<CPUCore> data_bus; // Data bus
+    tlm_utils::simple_target_socket<CPUCore> irq_line;    // IRQ line
+
+    CPUCore(sc_module_name name) :
+        sc_module(name),
+        inst_bus("inst_bus"),
+        data_bus("data_bus"),
+        irq_line("irq_line")
+    {
+        irq_line.register_b_transport(this, &CPUCore::b_transport);
+        irq_line.register_get_direct_mem_ptr(this, &CPUCore::get_direct_mem_ptr);
+        irq_line.register_transport_dbg(this, &CPUCore::transport_dbg);
+    }
+    virtual ~CPUCore() {}
+
+    // Core selection. Names are matched loosely: "cortex-m4", "M4",
+    // "CORTEX_M0_PLUS" and "cortex-m0+" all work.
+    typedef CPUCore* (*Factory)(sc_module_name name);
+    static void register_core(const char* name, Factory factory);
+    // nullptr if the core is unknown or was not built in (ARM_TLM_CORES)
+    static CPUCore* create(const std::string& name, sc_module_name module_name);
+    static bool has_core(const std::string& name);
+    static std::vector<std::string> available_cores();
+
+    virtual const char* core_name() const = 0;
+    virtual const char* arch_name() const = 0;
+
+    // TLM-2 interface methods for IRQ
+    virtual void b_transport(tlm_generic_payload& trans, sc_time& delay) = 0;
+    virtual bool get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data) = 0;
+    virtual unsigned int transport_dbg(tlm_generic_payload& trans) = 0;
+
+    // Image entry point, used when the reset vector is empty
+    virtual void set_entry_point(uint32_t entry) = 0;
+
+    // Debug interface for GDB server
+    virtual Registers* get_registers() const = 0;
+    virtual uint32_t read_memory_debug(uint32_t address) = 0;
+    virtual void write_memory_debug(uint32_t address, uint8_t data) = 0;
+    virtual void set_debug_mode(bool debug) = 0;
+    virtual bool is_debug_mode() const = 0;
+    virtual void set_single_step(bool step) = 0;
+    virtual bool is_single_step() const = 0;
+    virtual void set_debug_paused(bool paused) = 0;
+    // Data watchpoints, checked on every data access of the executing core
+    virtual Watchpoints& get_watchpoints() = 0;
+    // Software breakpoints, looked up by the core before every instruction
+    virtual Breakpoints& get_breakpoints() = 0;
+    virtual void set_gdb_server(GDBServer* gdb) = 0;
+
+    // Temporal decoupling quantum, shared by all initiators
+    static void set_global_quantum(const sc_time& quantum) { tlm_utils::tlm_quantumkeeper::set_global_quantum(quantum); }
+
+    // Timing and run control
+    virtual void set_clock_frequency(double hz) = 0;
+    virtual const sc_time& get_cycle_time() const = 0;
+    virtual void set_flash_wait_states(uint32_t wait_states) = 0;
+    // Address range whose instruction fetches pay the flash wait states
+    virtual void add_flash_region(uint32_t base, uint32_t size) = 0;
+    virtual void set_engine(ExecutionEngine engine) = 0;
+    virtual ExecutionEngine get_engine() const = 0;
+    virtual void set_stop_time(const sc_time& t) = 0;
+    virtual void set_max_instructions(uint64_t count) = 0;
+    virtual void set_profiler(Profiler* profiler) = 0;
+    virtual void set_instruction_trace(InstructionTrace* trace) = 0;
+
+    // Checkpointing
+    virtual void save_state(CheckpointWriter& out) const = 0;
+    virtual bool restore_state(CheckpointReader& in, const sc_time& resume_time) = 0;
+};
+
+// Registers a core's factory with CPUCore at static initialization
+struct CPUCoreRegistration {
+    CPUCoreRegistration(const char* name, CPUCore::Factory factory) {
+        CPUCore::register_core(name, factory);
+    }
+};
+
+#endif // CPU_CORE_H
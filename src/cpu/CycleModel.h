@@ -0,0 +1,178 @@
+#ifndef CYCLE_MODEL_H
+#define CYCLE_MODEL_H
+
+#include <cstdint>
+#include "Instruction.h"
+
+namespace ARM_CORE_NAMESPACE {
+
+// Cycle costs of the configured core, from the CYCLES_* table in
+// ARM_CortexM_Config.h. base_cycles() is the cost of an instruction that does
+// not branch; refill_cycles() is added when it writes the PC. Data-dependent
+// costs (divide early termination, exception entry/return) are charged by
+// the executor.
+class CycleModel
+{
+public:
+    static uint32_t base_cycles(const InstructionFields& fields) {
+        switch (fields.type) {
+            case INST_T16_LDR_PC:
+            case INST_T16_LDR_REG:
+            case INST_T16_LDRH_REG:
+            case INST_T16_LDRB_REG:
+            case INST_T16_LDRSB_REG:
+            case INST_T16_LDRSH_REG:
+            case INST_T16_LDR_IMM:
+            case INST_T16_LDRB_IMM:
+            case INST_T16_LDRH_IMM:
+            case INST_T16_LDR_SP:
+#if SUPPORTS_ARMV7_M
+            case INST_T32_LDR_IMM:
+            case INST_T32_LDRB_IMM:
+            case INST_T32_LDRH_IMM:
+            case INST_T32_LDRSB_IMM:
+            case INST_T32_LDRSH_IMM:
+            case INST_T32_LDR_PRE_POST:
+            case INST_T32_LDRB_PRE_POST:
+            case INST_T32_LDRSB_PRE_POST:
+            case INST_T32_LDRH_PRE_POST:
+            case INST_T32_LDRSH_PRE_POST:
+            case INST_T32_LDR_LIT:
+            case INST_T32_LDRB_LIT:
+            case INST_T32_LDRSB_LIT:
+            case INST_T32_LDRH_LIT:
+            case INST_T32_LDRSH_LIT:
+            case INST_T32_LDR_REG:
+            case INST_T32_LDRB_REG:
+            case INST_T32_LDRH_REG:
+            case INST_T32_LDRSB_REG:
+            case INST_T32_LDRSH_REG:
+            case INST_T32_LDRT:
+            case INST_T32_LDRSHT:
+            case INST_T32_TBB:
+            case INST_T32_TBH:
+#if HAS_EXCLUSIVE_ACCESS
+            case INST_T32_LDREX:
+            case INST_T32_LDREXB:
+            case INST_T32_LDREXH:
+#endif
+#endif
+                return CYCLES_LOAD;
+
+            case INST_T16_STR_REG:
+            case INST_T16_STRH_REG:
+            case INST_T16_STRB_REG:
+            case INST_T16_STR_IMM:
+            case INST_T16_STRB_IMM:
+            case INST_T16_STRH_IMM:
+            case INST_T16_STR_SP:
+#if SUPPORTS_ARMV7_M
+            case INST_T32_STR_IMM:
+            case INST_T32_STRB_IMM:
+            case INST_T32_STRH_IMM:
+            case INST_T32_STR_PRE_POST:
+            case INST_T32_STRB_PRE_POST:
+            case INST_T32_STRH_PRE_POST:
+            case INST_T32_STR_REG:
+            case INST_T32_STRB_REG:
+            case INST_T32_STRH_REG:
+#if HAS_EXCLUSIVE_ACCESS
+            case INST_T32_STREX:
+            case INST_T32_STREXB:
+            case INST_T32_STREXH:
+#endif
+#endif
+                return CYCLES_STORE;
+
+            // 1 + N for N registers transferred
+            case INST_T16_PUSH:
+            case INST_T16_POP:
+            case INST_T16_LDMIA:
+            case INST_T16_STMIA:
+#if SUPPORTS_ARMV7_M
+            case INST_T32_LDMIA:
+            case INST_T32_LDMDB:
+            case INST_T32_STMIA:
+            case INST_T32_STMDB:
+#endif
+                return 1 + static_cast<uint32_t>(__builtin_popcount(fields.reg_list));
+#if SUPPORTS_ARMV7_M
+            case INST_T32_LDRD:
+            case INST_T32_STRD:
+            case INST_T32_LDRD_LIT:
+                return CYCLES_LOAD + 1;
+#endif
+
+            case INST_T16_MUL:
+#if HAS_HARDWARE_DIVIDE
+            case INST_T32_MUL:
+#endif
+                return CYCLES_MULTIPLY;
+#if HAS_HARDWARE_DIVIDE
+            case INST_T32_MLA:
+            case INST_T32_MLS:
+                return CYCLES_MULTIPLY_ACC;
+            case INST_T32_UMULL:
+            case INST_T32_SMULL:
+            case INST_T32_UMLAL:
+            case INST_T32_SMLAL:
+                return CYCLES_LONG_MULTIPLY;
+            case INST_T32_UDIV:
+            case INST_T32_SDIV:
+                return CYCLES_DIVIDE_MIN;
+#endif
+
+#if HAS_MEMORY_BARRIERS
+            case INST_T32_DSB:
+            case INST_T32_DMB:
+            case INST_T32_ISB:
+                return CYCLES_BARRIER;
+#endif
+#if HAS_SYSTEM_REGISTERS
+            case INST_T32_MSR:
+            case INST_T32_MRS:
+                return CYCLES_SYSTEM_REGISTER;
+#endif
+
+            default:
+                return 1;
+        }
+    }
+
+    // Extra cycles when the instruction changed the PC
+    static uint32_t refill_cycles(const InstructionFields& fields) {
+        switch (fields.type) {
+#if HAS_T32_BL
+            case INST_T32_BL:
+                return CYCLES_BL - 1;
+#endif
+            case INST_T16_POP:
+            case INST_T16_LDMIA:
+#if SUPPORTS_ARMV7_M
+            case INST_T32_LDMIA:
+            case INST_T32_LDMDB:
+            case INST_T32_LDR_IMM:
+            case INST_T32_LDR_PRE_POST:
+            case INST_T32_LDR_LIT:
+            case INST_T32_LDR_REG:
+#endif
+                return CYCLES_LOAD_PC_REFILL;
+            default:
+                return CYCLES_BRANCH_TAKEN - 1;
+        }
+    }
+
+    // UDIV/SDIV with early termination: roughly one cycle per 4 quotient bits
+    static uint32_t divide_cycles(uint32_t dividend, uint32_t divisor) {
+        if (divisor == 0 || dividend < divisor) {
+            return CYCLES_DIVIDE_MIN;
+        }
+        uint32_t quotient_bits = static_cast<uint32_t>(__builtin_clz(divisor) - __builtin_clz(dividend)) + 1;
+        uint32_t cycles = CYCLES_DIVIDE_MIN + (quotient_bits + 3) / 4;
+        return cycles < CYCLES_DIVIDE_MAX ? cycles : CYCLES_DIVIDE_MAX;
+    }
+};
+
+} // namespace ARM_CORE_NAMESPACE
+
+#endif // CYCLE_MODEL_H
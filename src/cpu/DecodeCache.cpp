@@ -0,0 +1,58 @@
+#include "DecodeCache.h"
+
+namespace ARM_CORE_NAMESPACE {
+
+DecodeCache::DecodeCache(uint32_t entries) :
+    m_entries(entries),
+    m_mask(entries - 1),
+    m_lo(UINT64_MAX),
+    m_hi(0)
+{
+    flush();
+}
+
+const DecodeCache::Entry& DecodeCache::insert(uint32_t pc, const InstructionFields& fields, Execute::Handler handler, uint8_t length)
+{
+    Entry& entry = m_entries[index(pc)];
+    entry.pc = pc;
+    entry.valid = true;
+    entry.length = length;
+    entry.fields = fields;
+    entry.handler = handler;
+
+    // Grow the tracked code range so stores elsewhere stay on the fast reject path
+    if (pc < m_lo) m_lo = pc;
+    if (static_cast<uint64_t>(pc) + length > m_hi) m_hi = static_cast<uint64_t>(pc) + length;
+
+    return entry;
+}
+
+void DecodeCache::invalidate_range(uint32_t address, uint32_t size)
+{
+    // Large writes (e.g. reloading an image) are cheaper to handle with a full flush
+    if (size >= m_entries.size() * 2) {
+        flush();
+        return;
+    }
+
+    // A 32-bit instruction starting 2 bytes before the write also overlaps it
+    uint64_t first = (address >= 2 ? address - 2 : 0) & ~1ull;
+    uint64_t end = static_cast<uint64_t>(address) + size;
+    for (uint64_t pc = first; pc < end; pc += 2) {
+        Entry& entry = m_entries[index(static_cast<uint32_t>(pc))];
+        if (entry.valid && entry.pc == pc && pc + entry.length > address) {
+            entry.valid = false;
+        }
+    }
+}
+
+void DecodeCache::flush()
+{
+    for (auto& entry : m_entries) {
+        entry.valid = false;
+    }
+    m_lo = UINT64_MAX;
+    m_hi = 0;
+}
+
+} // namespace ARM_CORE_NAMESPACE
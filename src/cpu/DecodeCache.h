@@ -0,0 +1,63 @@
+#ifndef DECODE_CACHE_H
+#define DECODE_CACHE_H
+
+#include <cstdint>
+#include <vector>
+#include "Instruction.h"
+#include "Execute.h"
+
+namespace ARM_CORE_NAMESPACE {
+
+// Direct-mapped cache of decoded Thumb instructions, indexed by PC.
+// Entries are filled on first decode and dropped whenever the code bytes
+// backing them are written (data stores, DMI writes, GDB memory writes).
+class DecodeCache
+{
+public:
+    struct Entry {
+        uint32_t pc;              // Tag: address of the cached instruction
+        bool valid;
+        uint8_t length;           // Instruction size in bytes (2 or 4)
+        InstructionFields fields; // Decoded instruction
+        Execute::Handler handler; // Execute::handler_for(fields.type)
+    };
+
+    // Number of entries must be a power of two
+    explicit DecodeCache(uint32_t entries = 1u << 16);
+
+    // Return the cached entry for pc, or nullptr on a miss
+    const Entry* lookup(uint32_t pc) const {
+        const Entry& entry = m_entries[index(pc)];
+        return (entry.valid && entry.pc == pc) ? &entry : nullptr;
+    }
+
+    // Fill the slot for pc with a freshly decoded instruction
+    const Entry& insert(uint32_t pc, const InstructionFields& fields, Execute::Handler handler, uint8_t length);
+
+    // Drop every entry whose instruction bytes overlap [address, address + size)
+    void invalidate(uint32_t address, uint32_t size) {
+        // Cheap reject for stores outside the range of cached code (stack, heap, peripherals)
+        if (m_lo >= m_hi || static_cast<uint64_t>(address) + size <= m_lo || address >= m_hi) {
+            return;
+        }
+        invalidate_range(address, size);
+    }
+
+    // Drop all entries
+    void flush();
+
+private:
+    std::vector<Entry> m_entries;
+    uint32_t m_mask;
+
+    // Address range [m_lo, m_hi) covered by valid entries since the last flush
+    uint64_t m_lo;
+    uint64_t m_hi;
+
+    uint32_t index(uint32_t pc) const { return (pc >> 1) & m_mask; }
+    void invalidate_range(uint32_t address, uint32_t size);
+};
+
+} // namespace ARM_CORE_NAMESPACE
+
+#endif // DECODE_CACHE_H
@@ -7,6 +7,8 @@
 #include <iomanip>
 #include <cstring>
 
+namespace ARM_CORE_NAMESPACE {
+
 #if HAS_DSP_EXTENSIONS
 // Helper for parallel add/sub lane operations (16-bit x2 or 8-bit x4)
 static uint32_t saturate_signed(int32_t value, int bits, bool &sat) {
@@ -1023,6 +1025,21 @@ static std::string format_instruction(const InstructionFields& fields) {
         case INST_T32_NOP:
             oss << "nop.w";
             break;
+        case INST_T32_YIELD:
+            oss << "yield.w";
+            break;
+        case INST_T32_WFE:
+            oss << "wfe.w";
+            break;
+        case INST_T32_WFI:
+            oss << "wfi.w";
+            break;
+        case INST_T32_SEV:
+            oss << "sev.w";
+            break;
+        case INST_T32_SEVL:
+            oss << "sevl.w";
+            break;
         case INST_T32_CLREX:
             oss << "clrex";
             break;
@@ -1145,7 +1162,7 @@ Execute::Execute(sc_module_name name, Registers* registers) :
     LOG_INFO("Execute unit initialized");
 }
 
-bool Execute::execute_instruction(const InstructionFields& fields, void* data_bus)
+bool Execute::execute_instruction(const InstructionFields& fields, Handler handler, void* data_bus)
 {
 #if HAS_IT_BLOCKS
     // Check IT block state for conditional execution (ARMv7-M)
@@ -1159,13 +1176,10 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         // Get the condition result that was saved when IT block started
         bool cond_ok = m_registers->get_it_condition_result();
         should_execute = then_slot ? cond_ok : !cond_ok;
-        {
-            std::string dbg = std::string("IT: cond=") + std::to_string(it_condition) +
-                              ", then=" + (then_slot ? "T" : "E") +
-                              ", cond_ok=" + (cond_ok ? "1" : "0") +
-                              ", exec=" + (should_execute ? "1" : "0");
-            LOG_DEBUG(dbg);
-        }
+        LOG_DEBUG(std::string("IT: cond=") + std::to_string(it_condition) +
+                  ", then=" + (then_slot ? "T" : "E") +
+                  ", cond_ok=" + (cond_ok ? "1" : "0") +
+                  ", exec=" + (should_execute ? "1" : "0"));
 
         // Advance IT state after checking
         m_registers->advance_it_state();
@@ -1181,23 +1195,31 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         return false; // PC will be advanced by caller
     }
 #endif
-    std::stringstream ss;
-    if (fields.is_32bit) {
-        // For 32-bit instructions, print as two 16-bit halfwords
-        uint16_t first_half = (fields.opcode >> 16) & 0xFFFF;
-        uint16_t second_half = fields.opcode & 0xFFFF;
-        ss << std::hex << m_registers->get_pc()  << ":\t"<< std::hex << first_half << " " << std::hex << std::setw(4) << std::setfill('0') << second_half << "\t";
-    } else {
-        // For 16-bit instructions, print as single halfword
-        ss << std::hex << m_registers->get_pc()  << ":\t\t "<< std::hex << std::setw(4) << std::setfill('0') << (fields.opcode & 0xFFFF) << "\t";
+    // Disassembly is only built when debug logging is on
+    if (LOG_ENABLED(LOG_DEBUG)) {
+        std::stringstream ss;
+        if (fields.is_32bit) {
+            // For 32-bit instructions, print as two 16-bit halfwords
+            uint16_t first_half = (fields.opcode >> 16) & 0xFFFF;
+            uint16_t second_half = fields.opcode & 0xFFFF;
+            ss << std::hex << m_registers->get_pc()  << ":\t"<< std::hex << first_half << " " << std::hex << std::setw(4) << std::setfill('0') << second_half << "\t";
+        } else {
+            // For 16-bit instructions, print as single halfword
+            ss << std::hex << m_registers->get_pc()  << ":\t\t "<< std::hex << std::setw(4) << std::setfill('0') << (fields.opcode & 0xFFFF) << "\t";
+        }
+
+        // Log only when we're going to execute (or if IT not built)
+        LOG_DEBUG(ss.str() + format_instruction(fields));
     }
 
-    // Log only when we're going to execute (or if IT not built)
-    LOG_DEBUG(ss.str() + format_instruction(fields));
+    return handler(*this, fields, data_bus);
+}
 
-    bool pc_changed = false;
-    
-    switch (fields.type) {
+// Decode-time classification: called when an instruction enters the decode
+// cache or a translated block, never per executed instruction
+Execute::Handler Execute::handler_for(InstructionType type)
+{
+    switch (type) {
         // Branches
         case INST_T16_B_COND:
         case INST_T16_B:
@@ -1210,8 +1232,7 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T32_B_COND:
         case INST_T32_BL:
 #endif
-            pc_changed = execute_branch(fields);
-            break;
+            return handle<&Execute::execute_branch>;
         // Data processing
         case INST_T16_LSL_IMM:
         case INST_T16_LSR_IMM:
@@ -1247,8 +1268,7 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T16_SUB_SP_IMM7:
         case INST_T16_ADD_PC:
         case INST_T16_ADD_SP:
-            pc_changed = execute_data_processing(fields);
-            break;
+            return handle<&Execute::execute_data_processing>;
         // Load/Store
         case INST_T16_LDR_PC:
         case INST_T16_STR_REG:
@@ -1267,92 +1287,79 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T16_LDRH_IMM:
         case INST_T16_STR_SP:
         case INST_T16_LDR_SP:
-            pc_changed = execute_load_store(fields, data_bus);
-            break;
+            return handle_bus<&Execute::execute_load_store>;
         // Extend instructions
         case INST_T16_EXTEND:
-            pc_changed = execute_extend(fields);
-            break;
+            return handle<&Execute::execute_extend>;
         // Reverse instructions
         case INST_T16_REV:
         case INST_T16_REV16:
         case INST_T16_REVSH:
-            pc_changed = execute_rev(fields);
-            break;
+            return handle<&Execute::execute_rev>;
         // CPS instructions
         case INST_T16_CPS:
-            pc_changed = execute_cps(fields);
-            break;
+            return handle<&Execute::execute_cps>;
         // Multiple load/store
         case INST_T16_STMIA:
         case INST_T16_LDMIA:
         case INST_T16_PUSH:
         case INST_T16_POP:
-            pc_changed = execute_load_store_multiple(fields, data_bus);
-            break;
-        // Status/System (none for v6-M beyond hints)
-            pc_changed = execute_status_register(fields);
-            break;
+            return handle_bus<&Execute::execute_load_store_multiple>;
         case INST_T16_BKPT:
-            pc_changed = execute_miscellaneous(fields);
-            break;
+            return handle<&Execute::execute_miscellaneous>;
         case INST_T16_SVC:
-            pc_changed = execute_exception(fields);
-            break;
+            return handle<&Execute::execute_exception>;
 #if HAS_MEMORY_BARRIERS
         // T32 Memory barriers
         case INST_T32_DSB:
         case INST_T32_DMB:
         case INST_T32_ISB:
-            pc_changed = execute_memory_barrier(fields);
-            break;
+            return handle<&Execute::execute_memory_barrier>;
 #endif
 #if HAS_SYSTEM_REGISTERS
         // T32 System register access
         case INST_T32_MSR:
-            pc_changed = execute_msr(fields);
-            break;
+            return handle<&Execute::execute_msr>;
         case INST_T32_MRS:
-            pc_changed = execute_mrs(fields);
-            break;
+            return handle<&Execute::execute_mrs>;
 #endif
 #if HAS_CBZ_CBNZ
         // ARMv7-M Compare and Branch
         case INST_T16_CBZ:
         case INST_T16_CBNZ:
-            pc_changed = execute_cbz_cbnz(fields);
-            break;
+            return handle<&Execute::execute_cbz_cbnz>;
 #endif
 #if HAS_IT_BLOCKS
         // ARMv7-M If-Then blocks
         case INST_T16_IT:
-            pc_changed = execute_it(fields);
-            break;
+            return handle<&Execute::execute_it>;
 #endif
-#if HAS_EXTENDED_HINTS
-        // ARMv7-M Extended Hints
+#if SUPPORTS_ARMV6_M
+        // Hints
         case INST_T16_NOP:
         case INST_T16_WFI:
         case INST_T16_WFE:
         case INST_T16_SEV:
         case INST_T16_YIELD:
-            pc_changed = execute_extended_hint(fields);
-            break;
+#if SUPPORTS_ARMV7_M
+        case INST_T32_WFI:
+        case INST_T32_WFE:
+        case INST_T32_SEV:
+        case INST_T32_SEVL:
+        case INST_T32_YIELD:
+#endif
+            return handle<&Execute::execute_hint>;
 #endif
 
 #if SUPPORTS_ARMV7_M
         // ARMv7-M T32 Instructions
         case INST_T32_TBB:
         case INST_T32_TBH:
-            pc_changed = execute_table_branch(fields, data_bus);
-            break;
+            return handle_bus<&Execute::execute_table_branch>;
         case INST_T32_NOP:
-            // NOP.W - No operation, just continue
-            LOG_DEBUG("NOP.W");
-            break;
+            return handle<&Execute::execute_nop>;
         case INST_T32_CLREX:
-            pc_changed = execute_clrex(fields);
-            break;
+            return handle<&Execute::execute_clrex>;
         // T32 Data Processing Instructions
         case INST_T32_MOV_IMM:
         case INST_T32_MOVS_IMM:
@@ -1376,8 +1383,7 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T32_CMN_IMM:
         case INST_T32_TST_IMM:
         case INST_T32_TEQ_IMM:
-            pc_changed = execute_t32_data_processing(fields);
-            break;
+            return handle<&Execute::execute_t32_data_processing>;
         // T32 Data Processing Instructions (Register operands)
         case INST_T32_AND_REG:
         case INST_T32_ANDS_REG:
@@ -1416,12 +1422,9 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T32_UQADD16: case INST_T32_UQSUB16: case INST_T32_UQASX: case INST_T32_UQSAX: case INST_T32_UQADD8: case INST_T32_UQSUB8:
         case INST_T32_SHADD16: case INST_T32_SHSUB16: case INST_T32_SHASX: case INST_T32_SHSAX: case INST_T32_SHADD8: case INST_T32_SHSUB8:
         case INST_T32_UHADD16: case INST_T32_UHSUB16: case INST_T32_UHASX: case INST_T32_UHSAX: case INST_T32_UHADD8: case INST_T32_UHSUB8:
-            execute_parallel_addsub(m_registers, fields);
-            pc_changed = false; // does not modify pc
-            break;
+            return handle<&Execute::execute_dsp_parallel>;
 #endif
-            pc_changed = execute_t32_data_processing(fields);
-            break;
+            return handle<&Execute::execute_t32_data_processing>;
         // T32 Shift Instructions (register)
         case INST_T32_LSL_REG:
         case INST_T32_LSLS_REG:
@@ -1431,8 +1434,7 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T32_ASRS_REG:
         case INST_T32_ROR_REG:
         case INST_T32_RORS_REG:
-            pc_changed = execute_t32_shift_register(fields);
-            break;
+            return handle<&Execute::execute_t32_shift_register>;
         // T32 Load/Store Instructions
         case INST_T32_LDR_IMM:
         case INST_T32_LDRB_IMM:
@@ -1458,73 +1460,60 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T32_STR_REG:
         case INST_T32_STRB_REG:
         case INST_T32_STRH_REG:
-            pc_changed = execute_t32_load_store(fields, data_bus);
-            break;
+            return handle_bus<&Execute::execute_t32_load_store>;
         case INST_T32_LDRD:
         case INST_T32_STRD:
-            pc_changed = execute_t32_dual_load_store(fields, data_bus);
-            break;
+            return handle_bus<&Execute::execute_t32_dual_load_store>;
         // T32 Multiple Load/Store Instructions
         case INST_T32_LDMIA:
         case INST_T32_LDMDB:
         case INST_T32_STMIA:
         case INST_T32_STMDB:
-            pc_changed = execute_t32_multiple_load_store(fields, data_bus);
-            break;
+            return handle_bus<&Execute::execute_t32_multiple_load_store>;
 #if HAS_EXCLUSIVE_ACCESS
         case INST_T32_LDREX:
         case INST_T32_LDREXB:
         case INST_T32_LDREXH:
-            pc_changed = execute_exclusive_load(fields, data_bus);
-            break;
+            return handle_bus<&Execute::execute_exclusive_load>;
         case INST_T32_STREX:
         case INST_T32_STREXB:
         case INST_T32_STREXH:
-            pc_changed = execute_exclusive_store(fields, data_bus);
-            break;
+            return handle_bus<&Execute::execute_exclusive_store>;
 #endif
 #if HAS_HARDWARE_DIVIDE
         case INST_T32_UDIV:
         case INST_T32_SDIV:
-            pc_changed = execute_divide(fields);
-            break;
+            return handle<&Execute::execute_divide>;
         case INST_T32_MUL:
-            pc_changed = execute_mul(fields);
-            break;
+            return handle<&Execute::execute_mul>;
         case INST_T32_MLA:
-            pc_changed = execute_mla(fields);
-            break;
+            return handle<&Execute::execute_mla>;
         case INST_T32_MLS:
-            pc_changed = execute_mls(fields);
-            break;
+            return handle<&Execute::execute_mls>;
         case INST_T32_UMULL:
         case INST_T32_SMULL:
         case INST_T32_UMLAL:
         case INST_T32_SMLAL:
-            pc_changed = execute_long_multiply(fields);
-            break;
+            return handle<&Execute::execute_long_multiply>;
 #endif
 #if HAS_BITFIELD_INSTRUCTIONS
         case INST_T32_BFI:
         case INST_T32_BFC:
         case INST_T32_UBFX:
         case INST_T32_SBFX:
-            pc_changed = execute_bitfield(fields);
-            break;
+            return handle<&Execute::execute_bitfield>;
             
         // Sign/Zero Extend Instructions
         case INST_T32_SXTH:
         case INST_T32_SXTB:
         case INST_T32_UXTH:
         case INST_T32_UXTB:
-            pc_changed = execute_extend(fields);
-            break;
+            return handle<&Execute::execute_extend>;
 #endif
 #if HAS_SATURATING_ARITHMETIC
         case INST_T32_SSAT:
         case INST_T32_USAT:
-            pc_changed = execute_saturate(fields);
-            break;
+            return handle<&Execute::execute_saturate>;
 #endif
 #if HAS_BIT_MANIPULATION
         case INST_T32_CLZ:
@@ -1532,19 +1521,36 @@ bool Execute::execute_instruction(const InstructionFields& fields, void* data_bu
         case INST_T32_REV:
         case INST_T32_REV16:
         case INST_T32_REVSH:
-            pc_changed = execute_bit_manipulation(fields);
-            break;
+            return handle<&Execute::execute_bit_manipulation>;
 #endif
 #endif // SUPPORTS_ARMV7_M
 
         default:
-            LOG_WARNING("Unknown instruction type: " + std::to_string(fields.type) + " (may not be supported in " ARM_CORE_NAME ")");
-            break;
+            return handle<&Execute::execute_unknown>;
     }
-    
-    return pc_changed;
 }
 
+bool Execute::execute_nop(const InstructionFields& fields)
+{
+    // NOP.W - No operation, just continue
+    LOG_DEBUG("NOP.W");
+    return false;
+}
+
+bool Execute::execute_unknown(const InstructionFields& fields)
+{
+    LOG_WARNING("Unknown instruction type: " + std::to_string(fields.type) + " (may not be supported in " ARM_CORE_NAME ")");
+    return false;
+}
+
+#if HAS_DSP_EXTENSIONS
+bool Execute::execute_dsp_parallel(const InstructionFields& fields)
+{
+    execute_parallel_addsub(m_registers, fields);
+    return false; // does not modify pc
+}
+#endif
+
 bool Execute::execute_branch(const InstructionFields& fields)
 {
     // For conditional branches, check condition
@@ -1631,7 +1637,6 @@ bool Execute::execute_data_processing(const InstructionFields& fields)
 {
     uint32_t result = 0;
     bool carry = false;
-    bool overflow = false;
     uint32_t op1, op2;
     
     // Handle different instruction types
@@ -1646,27 +1651,21 @@ bool Execute::execute_data_processing(const InstructionFields& fields)
         case INST_T16_CMP_IMM: {
             op1 = m_registers->read_register(fields.rn);
             result = op1 - fields.imm;
-            carry = (op1 >= fields.imm);
-            overflow = ((op1 ^ fields.imm) & (op1 ^ result)) >> 31;
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, ~fields.imm, 1, result);
             return false;
         }
         case INST_T16_ADD_IMM8: {
             op1 = m_registers->read_register(fields.rn);
             result = op1 + fields.imm;
-            carry = (result < op1);
-            overflow = ((op1 ^ result) & (fields.imm ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, fields.imm, 0, result);
             return false;
         }
         case INST_T16_SUB_IMM8: {
             op1 = m_registers->read_register(fields.rn);
             result = op1 - fields.imm;
-            carry = (op1 >= fields.imm);
-            overflow = ((op1 ^ fields.imm) & (op1 ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, ~fields.imm, 1, result);
             return false;
         }
         
@@ -1675,38 +1674,30 @@ bool Execute::execute_data_processing(const InstructionFields& fields)
             op1 = m_registers->read_register(fields.rn);
             op2 = m_registers->read_register(fields.rm);
             result = op1 + op2;
-            carry = (result < op1);
-            overflow = ((op1 ^ result) & (op2 ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, op2, 0, result);
             return false;
         }
         case INST_T16_SUB_REG: {
             op1 = m_registers->read_register(fields.rn);
             op2 = m_registers->read_register(fields.rm);
             result = op1 - op2;
-            carry = (op1 >= op2);
-            overflow = ((op1 ^ op2) & (op1 ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, ~op2, 1, result);
             return false;
         }
         case INST_T16_ADD_IMM3: {
             op1 = m_registers->read_register(fields.rn);
             result = op1 + fields.imm;
-            carry = (result < op1);
-            overflow = ((op1 ^ result) & (fields.imm ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, fields.imm, 0, result);
             return false;
         }
         case INST_T16_SUB_IMM3: {
             op1 = m_registers->read_register(fields.rn);
             result = op1 - fields.imm;
-            carry = (op1 >= fields.imm);
-            overflow = ((op1 ^ fields.imm) & (op1 ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, ~fields.imm, 1, result);
             return false;
         }
         
@@ -1789,10 +1780,8 @@ bool Execute::execute_data_processing(const InstructionFields& fields)
             op2 = m_registers->read_register(fields.rm);
             uint32_t c_in = m_registers->get_c_flag() ? 1 : 0;
             result = op1 + op2 + c_in;
-            carry = (result < op1) || (result == op1 && c_in);
-            overflow = ((op1 ^ result) & (op2 ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, op2, c_in, result);
             return false;
         }
         case INST_T16_SBC: {
@@ -1800,10 +1789,8 @@ bool Execute::execute_data_processing(const InstructionFields& fields)
             op2 = m_registers->read_register(fields.rm);
             uint32_t c_in = m_registers->get_c_flag() ? 1 : 0;
             result = op1 - op2 - (1 - c_in);
-            carry = (op1 >= op2) && (op1 >= (op2 + (1 - c_in)));
-            overflow = ((op1 ^ op2) & (op1 ^ result)) >> 31;
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, ~op2, c_in, result);
             return false;
         }
         case INST_T16_ROR: {
@@ -1836,28 +1823,22 @@ bool Execute::execute_data_processing(const InstructionFields& fields)
         case INST_T16_NEG: {
             op2 = m_registers->read_register(fields.rm);
             result = 0 - op2;
-            carry = (op2 == 0);
-            overflow = (op2 == 0x80000000);
             m_registers->write_register(fields.rd, result);
-            update_flags(result, carry, overflow);
+            update_flags_add(0, ~op2, 1, result);
             return false;
         }
         case INST_T16_CMP_REG: {
             op1 = m_registers->read_register(fields.rn);
             op2 = m_registers->read_register(fields.rm);
             result = op1 - op2;
-            carry = (op1 >= op2);
-            overflow = ((op1 ^ op2) & (op1 ^ result)) >> 31;
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, ~op2, 1, result);
             return false;
         }
         case INST_T16_CMN: {
             op1 = m_registers->read_register(fields.rn);
             op2 = m_registers->read_register(fields.rm);
             result = op1 + op2;
-            carry = (result < op1);
-            overflow = ((op1 ^ result) & (op2 ^ result)) >> 31;
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, op2, 0, result);
             return false;
         }
         case INST_T16_ORR: {
@@ -1905,9 +1886,7 @@ bool Execute::execute_data_processing(const InstructionFields& fields)
             op1 = m_registers->read_register(fields.rd);
             op2 = m_registers->read_register(fields.rm);
             result = op1 - op2;
-            carry = (op1 >= op2);
-            overflow = ((op1 ^ op2) & (op1 ^ result)) >> 31;
-            update_flags(result, carry, overflow);
+            update_flags_add(op1, ~op2, 1, result);
             return false;
         }
         case INST_T16_MOV_HI: {
@@ -2229,6 +2208,11 @@ bool Execute::execute_miscellaneous(const InstructionFields& fields)
 
     // Handle BKPT instruction
     if (fields.type == INST_T16_BKPT) {
+        if (fields.imm == 0xAB && m_cpu) {
+            // Semihosting trap
+            m_cpu->semihosting_call();
+            return false;
+        }
         LOG_INFO("BKPT instruction executed with immediate value: " + hex32(fields.imm));
         // In a real system, this would trigger a debug exception
         // For simulation, we just log it and continue
@@ -2258,11 +2242,12 @@ bool Execute::execute_exception(const InstructionFields& fields)
 
 bool Execute::check_condition(uint8_t condition)
 {
-    // ARM condition code checking based on CPSR flags
-    bool n = m_registers->get_n_flag();
-    bool z = m_registers->get_z_flag();
-    bool c = m_registers->get_c_flag();
-    bool v = m_registers->get_v_flag();
+    // ARM condition code checking based on CPSR flags (materialized once)
+    uint32_t nzcv = m_registers->get_nzcv();
+    bool n = (nzcv >> 31) & 1;
+    bool z = (nzcv >> 30) & 1;
+    bool c = (nzcv >> 29) & 1;
+    bool v = (nzcv >> 28) & 1;
     
     switch (condition) {
         case 0x0: // EQ - Equal (Z set)
@@ -2304,15 +2289,30 @@ bool Execute::check_condition(uint8_t condition)
 
 void Execute::update_flags(uint32_t result, bool carry, bool overflow)
 {
-    m_registers->set_n_flag((result & 0x80000000) != 0);
-    m_registers->set_z_flag(result == 0);
-    m_registers->set_c_flag(carry);
-    m_registers->set_v_flag(overflow);
+    m_registers->set_flags_result(result, carry, overflow);
+}
+
+void Execute::update_flags_add(uint32_t a, uint32_t b, uint32_t carry_in, uint32_t result)
+{
+    m_registers->set_flags_add(a, b, carry_in, result);
+}
+
+inline void Execute::note_memory_access(uint32_t address, uint32_t value, uint32_t size, bool write)
+{
+    if (m_watchpoints->armed() && m_watchpoints->check(address, size, write)) {
+        m_cpu->request_block_exit();  // Report before the next instruction
+    }
+    if (m_trace) {
+        m_trace->memory_access(address, value, size, write);
+    }
+    if (LOG_ENABLED(LOG_TRACE)) {
+        Log::getInstance().log_memory_access(address, value, size, write);
+    }
 }
 
 uint32_t Execute::read_memory(uint32_t address, uint32_t size, void* socket)
 {
-    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPU>*>(socket);
+    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPUCore>*>(socket);
 
     // DMI fast path (cache retained across calls)
     if (m_data_dmi_valid && address >= m_data_dmi.get_start_address() && (address + size - 1) <= m_data_dmi.get_end_address()) {
@@ -2320,11 +2320,9 @@ uint32_t Execute::read_memory(uint32_t address, uint32_t size, void* socket)
         uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
         uint32_t val = 0;
         std::memcpy(&val, base + off, size);
-        wait(m_data_dmi.get_read_latency());
+        m_cpu->consume_time(m_data_dmi.get_read_latency());
         Performance::getInstance().increment_memory_reads();
-        if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-            Log::getInstance().log_memory_access(address, val, size, false);
-        }
+        note_memory_access(address, val, size, false);
         return val;
     }
 
@@ -2341,11 +2339,9 @@ uint32_t Execute::read_memory(uint32_t address, uint32_t size, void* socket)
             uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
             uint32_t val = 0;
             std::memcpy(&val, base + off, size);
-            wait(m_data_dmi.get_read_latency());
+            m_cpu->consume_time(m_data_dmi.get_read_latency());
             Performance::getInstance().increment_memory_reads();
-            if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-                Log::getInstance().log_memory_access(address, val, size, false);
-            }
+            note_memory_access(address, val, size, false);
             return val;
         }
     }
@@ -2362,33 +2358,32 @@ uint32_t Execute::read_memory(uint32_t address, uint32_t size, void* socket)
     trans.set_byte_enable_ptr(nullptr);
     trans.set_dmi_allowed(true);
     trans.set_response_status(TLM_INCOMPLETE_RESPONSE);
+    // Peripheral access: let the target see the CPU's current time
+    m_cpu->sync_time();
     (*bus)->b_transport(trans, delay);
     if (trans.get_response_status() != TLM_OK_RESPONSE) {
         LOG_ERROR("Data read failed at address " + hex32(address));
         return 0;
     }
-    wait(delay);
+    m_cpu->consume_time(delay);
     Performance::getInstance().increment_memory_reads();
-    if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-        Log::getInstance().log_memory_access(address, data, size, false);
-    }
+    note_memory_access(address, data, size, false);
     return data;
 }
 
 void Execute::write_memory(uint32_t address, uint32_t data, uint32_t size, void* socket)
 {
-    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPU>*>(socket);
+    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPUCore>*>(socket);
 
     // DMI fast path for writes
     if (m_data_dmi_valid && address >= m_data_dmi.get_start_address() && (address + size - 1) <= m_data_dmi.get_end_address() && m_data_dmi.is_write_allowed()) {
         auto base = m_data_dmi.get_dmi_ptr();
         uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
         std::memcpy(base + off, &data, size);
-        wait(m_data_dmi.get_write_latency());
+        if (m_cpu) m_cpu->invalidate_decoded(address, size);
+        m_cpu->consume_time(m_data_dmi.get_write_latency());
         Performance::getInstance().increment_memory_writes();
-        if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-            Log::getInstance().log_memory_access(address, data, size, true);
-        }
+        note_memory_access(address, data, size, true);
         return;
     }
 
@@ -2404,11 +2399,10 @@ void Execute::write_memory(uint32_t address, uint32_t data, uint32_t size, void*
             auto base = m_data_dmi.get_dmi_ptr();
             uint64_t off = static_cast<uint64_t>(address) - static_cast<uint64_t>(m_data_dmi.get_start_address());
             std::memcpy(base + off, &data, size);
-            wait(m_data_dmi.get_write_latency());
+            if (m_cpu) m_cpu->invalidate_decoded(address, size);
+            m_cpu->consume_time(m_data_dmi.get_write_latency());
             Performance::getInstance().increment_memory_writes();
-            if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-                Log::getInstance().log_memory_access(address, data, size, true);
-            }
+            note_memory_access(address, data, size, true);
             return;
         }
     }
@@ -2424,16 +2418,17 @@ void Execute::write_memory(uint32_t address, uint32_t data, uint32_t size, void*
     trans.set_byte_enable_ptr(nullptr);
     trans.set_dmi_allowed(true);
     trans.set_response_status(TLM_INCOMPLETE_RESPONSE);
+    // Peripheral access: let the target see the CPU's current time
+    m_cpu->sync_time();
     (*bus)->b_transport(trans, delay);
     if (trans.get_response_status() != TLM_OK_RESPONSE) {
         LOG_ERROR("Data write failed at address " + hex32(address));
         return;
     }
-    wait(delay);
+    if (m_cpu) m_cpu->invalidate_decoded(address, size);
+    m_cpu->consume_time(delay);
     Performance::getInstance().increment_memory_writes();
-    if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-        Log::getInstance().log_memory_access(address, data, size, true);
-    }
+    note_memory_access(address, data, size, true);
 }
 
 bool Execute::execute_extend(const InstructionFields& fields)
@@ -2810,43 +2805,52 @@ bool Execute::execute_it(const InstructionFields& fields)
 }
 #endif
 
-#if HAS_EXTENDED_HINTS
-bool Execute::execute_extended_hint(const InstructionFields& fields)
+#if SUPPORTS_ARMV6_M
+bool Execute::execute_hint(const InstructionFields& fields)
 {
-    // ARMv7-M Extended Hint instructions
     switch (fields.type) {
         case INST_T16_NOP:
             LOG_DEBUG("nop - No Operation");
-            // Hint to scheduler that this thread can yield
-            wait(1, SC_NS); // Minimal wait to allow other processes
             break;
 
         case INST_T16_WFI:
+#if SUPPORTS_ARMV7_M
+        case INST_T32_WFI:
+#endif
             LOG_DEBUG("WFI - Wait for Interrupt");
-            // In real implementation: put core into low-power state until interrupt
-            wait(100, SC_NS); // Simulate brief wait
+            // Sleep until the NVIC delivers an exception: simulated time jumps
+            // straight to the next interrupt source (e.g. SysTick expiry)
+            m_cpu->wait_for_interrupt();
             break;
             
         case INST_T16_WFE:
+#if SUPPORTS_ARMV7_M
+        case INST_T32_WFE:
+#endif
             LOG_DEBUG("WFE - Wait for Event");
-            // In real implementation: put core into low-power state until event
-            wait(50, SC_NS); // Simulate brief wait
+            // Consumes a latched event, otherwise sleeps like WFI
+            m_cpu->wait_for_event();
             break;
             
         case INST_T16_SEV:
+#if SUPPORTS_ARMV7_M
+        case INST_T32_SEV:
+        case INST_T32_SEVL:
+#endif
             LOG_DEBUG("SEV - Send Event");
-            // In real implementation: send event to other cores/wake WFE
-            // For single-core simulation, this is essentially a NOP
+            // Single core: only latches the event register for the next WFE
+            m_cpu->send_event();
             break;
             
         case INST_T16_YIELD:
+#if SUPPORTS_ARMV7_M
+        case INST_T32_YIELD:
+#endif
             LOG_DEBUG("YIELD - Yield processor");
-            // Hint to scheduler that this thread can yield
-            wait(1, SC_NS); // Minimal wait to allow other processes
             break;
             
         default:
-            LOG_WARNING("Unknown extended hint instruction: " + std::to_string(fields.type));
+            LOG_WARNING("Unknown hint instruction: " + std::to_string(fields.type));
             break;
     }
     
@@ -2942,6 +2946,9 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
     uint32_t result = 0;
     bool carry = false;
     bool overflow = false;
+    // Add/subtract record their operands for lazy C/V: result = add_a + add_b + add_carry_in
+    bool add_flags = false;
+    uint32_t add_a = 0, add_b = 0, add_carry_in = 0;
     
     switch (fields.type) {
         case INST_T32_MOV_IMM:
@@ -2964,16 +2971,20 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             
         case INST_T32_ADD_IMM:
             result = operand1 + operand2;
-            carry = result < operand1;  // Carry on unsigned overflow
-            overflow = ((operand1 ^ result) & (operand2 ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = operand2;
+            add_carry_in = 0;
             LOG_DEBUG("ADD.W " + reg_name(fields.rd) + ", " + reg_name(fields.rn) + 
                      ", #" + hex32(operand2) + " -> " + hex32(result));
             break;
             
         case INST_T32_SUB_IMM:
             result = operand1 - operand2;
-            carry = operand1 >= operand2;  // No borrow
-            overflow = ((operand1 ^ operand2) & (operand1 ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = ~operand2;
+            add_carry_in = 1;
             LOG_DEBUG("SUB.W " + reg_name(fields.rd) + ", " + reg_name(fields.rn) + 
                      ", #" + hex32(operand2) + " -> " + hex32(result));
             break;
@@ -3013,8 +3024,10 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t apsr = m_registers->get_apsr();
             uint32_t carry_in = (apsr & 0x20000000) ? 1 : 0;
             result = operand1 + operand2 + carry_in;
-            carry = (result < operand1) || (carry_in && result == operand1);
-            overflow = ((operand1 ^ result) & (operand2 ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = operand2;
+            add_carry_in = carry_in;
             LOG_DEBUG("ADC.W " + reg_name(fields.rd) + ", " + reg_name(fields.rn) + 
                      ", #" + hex32(operand2) + " -> " + hex32(result));
             break;
@@ -3024,8 +3037,10 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t apsr = m_registers->get_apsr();
             uint32_t carry_in = (apsr & 0x20000000) ? 1 : 0;
             result = operand1 - operand2 - (1 - carry_in);
-            carry = (operand1 >= operand2) && (carry_in || operand1 > operand2);
-            overflow = ((operand1 ^ operand2) & (operand1 ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = ~operand2;
+            add_carry_in = carry_in;
             LOG_DEBUG("SBC.W " + reg_name(fields.rd) + ", " + reg_name(fields.rn) + 
                      ", #" + hex32(operand2) + " -> " + hex32(result));
             break;
@@ -3033,8 +3048,10 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
 
         case INST_T32_RSB_IMM:
             result = operand2 - operand1;
-            carry = operand2 >= operand1;
-            overflow = ((operand2 ^ operand1) & (operand2 ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand2;
+            add_b = ~operand1;
+            add_carry_in = 1;
             LOG_DEBUG("RSB.W " + reg_name(fields.rd) + ", " + reg_name(fields.rn) + 
                      ", #" + hex32(operand2) + " -> " + hex32(result));
             break;
@@ -3072,18 +3089,14 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
         // Compare instructions (no result register)
         case INST_T32_CMP_IMM:
             result = operand1 - operand2;
-            carry = operand1 >= operand2;
-            overflow = ((operand1 ^ operand2) & (operand1 ^ result) & 0x80000000) != 0;
             LOG_DEBUG("CMP.W " + reg_name(fields.rn) + ", #" + hex32(operand2));
-            update_flags(result, carry, overflow);
+            update_flags_add(operand1, ~operand2, 1, result);
             return false;
             
         case INST_T32_CMN_IMM:
             result = operand1 + operand2;
-            carry = result < operand1;
-            overflow = ((operand1 ^ result) & (operand2 ^ result) & 0x80000000) != 0;
             LOG_DEBUG("CMN.W " + reg_name(fields.rn) + ", #" + hex32(operand2));
-            update_flags(result, carry, overflow);
+            update_flags_add(operand1, operand2, 0, result);
             return false;
             
         case INST_T32_TST_IMM:
@@ -3179,14 +3192,16 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t operand2_shifted = apply_shift(read_register_with_pc_adjust(m_registers, fields.rm), 
                                                    fields.shift_type, fields.shift_amount);
             result = operand1 + operand2_shifted;
-            carry = result < operand1;
-            overflow = ((operand1 ^ result) & (operand2_shifted ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = operand2_shifted;
+            add_carry_in = 0;
             bool set_flags = (fields.type == INST_T32_ADDS_REG);
             LOG_DEBUG("ADD.W " + reg_name(fields.rd) + 
                      ", " + reg_name(fields.rn) + ", " + reg_name(fields.rm) + 
                      " -> " + hex32(result));
             if (set_flags) {
-                update_flags(result, carry, overflow);
+                update_flags_add(add_a, add_b, add_carry_in, result);
             }
             break;
         }
@@ -3196,14 +3211,16 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t operand2_shifted = apply_shift(read_register_with_pc_adjust(m_registers, fields.rm), 
                                                    fields.shift_type, fields.shift_amount);
             result = operand1 - operand2_shifted;
-            carry = operand1 >= operand2_shifted;
-            overflow = ((operand1 ^ operand2_shifted) & (operand1 ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = ~operand2_shifted;
+            add_carry_in = 1;
             bool set_flags = (fields.type == INST_T32_SUBS_REG);
             LOG_DEBUG("SUB.W " + reg_name(fields.rd) + 
                      ", " + reg_name(fields.rn) + ", " + reg_name(fields.rm) + 
                      " -> " + hex32(result));
             if (set_flags) {
-                update_flags(result, carry, overflow);
+                update_flags_add(add_a, add_b, add_carry_in, result);
             }
             break;
         }
@@ -3215,14 +3232,16 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t apsr = m_registers->get_apsr();
             uint32_t carry_in = (apsr & 0x20000000) ? 1 : 0;
             result = operand1 + operand2_shifted + carry_in;
-            carry = (result < operand1) || (carry_in && result == operand1);
-            overflow = ((operand1 ^ result) & (operand2_shifted ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = operand2_shifted;
+            add_carry_in = carry_in;
             bool set_flags = (fields.type == INST_T32_ADCS_REG);
             LOG_DEBUG("ADC.W " + reg_name(fields.rd) + 
                      ", " + reg_name(fields.rn) + ", " + reg_name(fields.rm) + 
                      " -> " + hex32(result));
             if (set_flags) {
-                update_flags(result, carry, overflow);
+                update_flags_add(add_a, add_b, add_carry_in, result);
             }
             break;
         }
@@ -3234,14 +3253,16 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t apsr = m_registers->get_apsr();
             uint32_t carry_in = (apsr & 0x20000000) ? 1 : 0;
             result = operand1 - operand2_shifted - (1 - carry_in);
-            carry = (operand1 >= operand2_shifted) && (carry_in || operand1 > operand2_shifted);
-            overflow = ((operand1 ^ operand2_shifted) & (operand1 ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand1;
+            add_b = ~operand2_shifted;
+            add_carry_in = carry_in;
             bool set_flags = (fields.type == INST_T32_SBCS_REG);
             LOG_DEBUG("SBC.W " + reg_name(fields.rd) + 
                      ", " + reg_name(fields.rn) + ", " + reg_name(fields.rm) + 
                      " -> " + hex32(result));
             if (set_flags) {
-                update_flags(result, carry, overflow);
+                update_flags_add(add_a, add_b, add_carry_in, result);
             }
             break;
         }
@@ -3251,14 +3272,16 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t operand2_shifted = apply_shift(read_register_with_pc_adjust(m_registers, fields.rm), 
                                                    fields.shift_type, fields.shift_amount);
             result = operand2_shifted - operand1;
-            carry = operand2_shifted >= operand1;
-            overflow = ((operand2_shifted ^ operand1) & (operand2_shifted ^ result) & 0x80000000) != 0;
+            add_flags = true;
+            add_a = operand2_shifted;
+            add_b = ~operand1;
+            add_carry_in = 1;
             bool set_flags = (fields.type == INST_T32_RSBS_REG);
             LOG_DEBUG("RSB.W " + reg_name(fields.rd) + 
                      ", " + reg_name(fields.rn) + ", " + reg_name(fields.rm) + 
                      " -> " + hex32(result));
             if (set_flags) {
-                update_flags(result, carry, overflow);
+                update_flags_add(add_a, add_b, add_carry_in, result);
             }
             break;
         }
@@ -3317,10 +3340,8 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t operand2_shifted = apply_shift(read_register_with_pc_adjust(m_registers, fields.rm), 
                                                    fields.shift_type, fields.shift_amount);
             result = operand1 - operand2_shifted;
-            carry = operand1 >= operand2_shifted;
-            overflow = ((operand1 ^ operand2_shifted) & (operand1 ^ result) & 0x80000000) != 0;
             LOG_DEBUG("CMP.W " + reg_name(fields.rn) + ", " + reg_name(fields.rm));
-            update_flags(result, carry, overflow);
+            update_flags_add(operand1, ~operand2_shifted, 1, result);
             return false;
         }
             
@@ -3328,10 +3349,8 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
             uint32_t operand2_shifted = apply_shift(read_register_with_pc_adjust(m_registers, fields.rm), 
                                                    fields.shift_type, fields.shift_amount);
             result = operand1 + operand2_shifted;
-            carry = result < operand1;
-            overflow = ((operand1 ^ result) & (operand2_shifted ^ result) & 0x80000000) != 0;
             LOG_DEBUG("CMN.W " + reg_name(fields.rn) + ", " + reg_name(fields.rm));
-            update_flags(result, carry, overflow);
+            update_flags_add(operand1, operand2_shifted, 0, result);
             return false;
         }
             
@@ -3347,7 +3366,11 @@ bool Execute::execute_t32_data_processing(const InstructionFields& fields)
     
     // Update flags if S bit is set
     if (fields.s_bit) {
-        update_flags(result, carry, overflow);
+        if (add_flags) {
+            update_flags_add(add_a, add_b, add_carry_in, result);
+        } else {
+            update_flags(result, carry, overflow);
+        }
     }
     
     return false;
@@ -3454,10 +3477,8 @@ bool Execute::execute_t32_shift_register(const InstructionFields& fields)
     
     // Update flags if S bit is set
     if (fields.s_bit) {
-        m_registers->set_n_flag((result & 0x80000000) != 0);
-        m_registers->set_z_flag(result == 0);
-        m_registers->set_c_flag(carry_out);
         // V flag is unaffected by shift operations
+        update_flags(result, carry_out, m_registers->get_v_flag());
     }
     
     return false;
@@ -3821,6 +3842,15 @@ bool Execute::execute_divide(const InstructionFields& fields)
     uint32_t dividend = m_registers->read_register(fields.rn);
     uint32_t divisor = m_registers->read_register(fields.rm);
     uint32_t result;
+
+    // Early termination: the cost depends on the magnitudes of the operands
+    uint32_t magnitude_dividend = dividend;
+    uint32_t magnitude_divisor = divisor;
+    if (fields.type == INST_T32_SDIV) {
+        magnitude_dividend = (int32_t)dividend < 0 ? 0u - dividend : dividend;
+        magnitude_divisor = (int32_t)divisor < 0 ? 0u - divisor : divisor;
+    }
+    m_cpu->add_cycles(CycleModel::divide_cycles(magnitude_dividend, magnitude_divisor) - CYCLES_DIVIDE_MIN);
     
     // Check for division by zero
     if (divisor == 0) {
@@ -4186,7 +4216,7 @@ bool Execute::execute_bit_manipulation(const InstructionFields& fields)
 
 bool Execute::execute_t32_dual_load_store(const InstructionFields& fields, void* data_bus)
 {
-    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPU>*>(data_bus);
+    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPUCore>*>(data_bus);
     
     // Calculate base address
     uint32_t base_addr;
@@ -4261,7 +4291,7 @@ bool Execute::execute_t32_dual_load_store(const InstructionFields& fields, void*
 
 bool Execute::execute_t32_multiple_load_store(const InstructionFields& fields, void* data_bus)
 {
-    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPU>*>(data_bus);
+    auto* bus = static_cast<tlm_utils::simple_initiator_socket<CPUCore>*>(data_bus);
     
     uint32_t address = m_registers->read_register(fields.rn);
     uint16_t reg_list = fields.reg_list;
@@ -4374,4 +4404,6 @@ uint32_t Execute::apply_shift(uint32_t value, uint8_t shift_type, uint8_t shift_
     }
 }
 
-#endif // SUPPORTS_ARMV7_M
\ No newline at end of file
+#endif // SUPPORTS_ARMV7_M
+
+} // namespace ARM_CORE_NAMESPACE
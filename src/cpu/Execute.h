@@ -7,12 +7,17 @@
 #include <cstdint>
 #include "Instruction.h"
 #include "Registers.h"
-// Forward declare CPU to avoid circular dependency in headers
-class CPU;
+#include "InstructionTrace.h"
+#include "Watchpoints.h"
 
 using namespace sc_core;
 using namespace tlm;
 
+namespace ARM_CORE_NAMESPACE {
+
+// Forward declare CPU to avoid circular dependency in headers
+class CPU;
+
 // Forward declaration to avoid circular dependency
 template<typename T> 
 using simple_initiator_socket_base = tlm_utils::simple_initiator_socket<T>;
@@ -25,13 +30,25 @@ public:
     Execute(sc_module_name name, Registers* registers);
     // Wire back to CPU to trigger synchronous exceptions (e.g., SVC)
     void set_cpu(CPU* cpu) { m_cpu = cpu; }
+    // Record data accesses in a binary execution trace (nullptr: off)
+    void set_trace(InstructionTrace* trace) { m_trace = trace; }
+    // Data watchpoints to check; set by the CPU before anything executes
+    void set_watchpoints(Watchpoints* watchpoints) { m_watchpoints = watchpoints; }
     
+    // Instruction handler, resolved once per instruction at decode time and
+    // kept next to the decoded fields (decode cache, translated blocks) so
+    // execution is a single indirect call
+    typedef bool (*Handler)(Execute& execute, const InstructionFields& fields, void* data_bus);
+    static Handler handler_for(InstructionType type);
+
     // Execute instruction - using void* to avoid circular dependency
-    bool execute_instruction(const InstructionFields& fields, void* data_bus);
+    bool execute_instruction(const InstructionFields& fields, Handler handler, void* data_bus);
     
 private:
     Registers* m_registers;
     CPU* m_cpu { nullptr };
+    InstructionTrace* m_trace { nullptr };
+    Watchpoints* m_watchpoints { nullptr };
     // DMI cache for data bus accesses from Execute
     bool m_data_dmi_valid { false };
     tlm_dmi m_data_dmi;
@@ -43,6 +60,16 @@ private:
     uint32_t m_exclusive_size { 0 };  // 1, 2, or 4 bytes
 #endif
     
+    // Adapt the execution methods below to the Handler signature
+    template<bool (Execute::*Method)(const InstructionFields&)>
+    static bool handle(Execute& execute, const InstructionFields& fields, void*) {
+        return (execute.*Method)(fields);
+    }
+    template<bool (Execute::*Method)(const InstructionFields&, void*)>
+    static bool handle_bus(Execute& execute, const InstructionFields& fields, void* data_bus) {
+        return (execute.*Method)(fields, data_bus);
+    }
+
     // Execution methods for different instruction types
     bool execute_branch(const InstructionFields& fields);
     bool execute_data_processing(const InstructionFields& fields);
@@ -57,6 +84,11 @@ private:
     bool execute_memory_barrier(const InstructionFields& fields);
     bool execute_msr(const InstructionFields& fields);
     bool execute_mrs(const InstructionFields& fields);
+    bool execute_nop(const InstructionFields& fields);
+    bool execute_unknown(const InstructionFields& fields);
+#if HAS_DSP_EXTENSIONS
+    bool execute_dsp_parallel(const InstructionFields& fields);
+#endif
     
 #if HAS_CBZ_CBNZ
     // ARMv7-M Compare and Branch execution
@@ -66,9 +98,9 @@ private:
     // ARMv7-M If-Then block execution
     bool execute_it(const InstructionFields& fields);
 #endif
-#if HAS_EXTENDED_HINTS
-    // ARMv7-M Extended Hint execution
-    bool execute_extended_hint(const InstructionFields& fields);
+#if SUPPORTS_ARMV6_M
+    // Hints: NOP, YIELD, WFE, WFI, SEV (16-bit and .W forms)
+    bool execute_hint(const InstructionFields& fields);
 #endif
     
 #if SUPPORTS_ARMV7_M
@@ -105,6 +137,8 @@ private:
     // Helper methods
     uint32_t compute_operand2(const InstructionFields& fields);
     void update_flags(uint32_t result, bool carry, bool overflow);
+    // Add/subtract: flags derived lazily from result = a + b + carry_in
+    void update_flags_add(uint32_t a, uint32_t b, uint32_t carry_in, uint32_t result);
     bool check_condition(uint8_t condition);
     
     // Shift and formatting helpers
@@ -113,6 +147,10 @@ private:
     // Memory access helpers
     uint32_t read_memory(uint32_t address, uint32_t size, void* socket);
     void write_memory(uint32_t address, uint32_t data, uint32_t size, void* socket);
+    // Watchpoints, execution trace and TRACE-level log of a completed data access
+    void note_memory_access(uint32_t address, uint32_t value, uint32_t size, bool write);
 };
 
+} // namespace ARM_CORE_NAMESPACE
+
 #endif // EXECUTE_H
\ No newline at end of file
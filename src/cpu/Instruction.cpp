@@ -3,8 +3,16 @@
 #include "Log.h"
 #include <sstream>
 
-Instruction::Instruction(sc_module_name name) : sc_module(name)
+namespace ARM_CORE_NAMESPACE {
+
+Instruction::Instruction(sc_module_name name) :
+    sc_module(name),
+    m_thumb16_table(0x10000)
 {
+    // Every 16-bit encoding decodes the same way each time: decode them all once
+    for (uint32_t halfword = 0; halfword < 0x10000; halfword++) {
+        m_thumb16_table[halfword] = decode_thumb16_instruction(static_cast<uint16_t>(halfword));
+    }
     LOG_INFO("Instruction decoder initialized for " ARM_CORE_NAME " (" ARM_ARCH_NAME ")");
 }
 
@@ -17,12 +25,12 @@ InstructionFields Instruction::decode(uint32_t instruction, bool is_32bit)
         // Handle 32-bit Thumb instructions
         fields = decode_thumb32_instruction(((instruction & 0xFFFF) << 16) | ((instruction >> 16) & 0xFFFF));
     } else {
-        // Handle 16-bit Thumb instructions
-        fields = decode_thumb16_instruction(instruction & 0xFFFF);
+        // Handle 16-bit Thumb instructions: prebuilt table lookup
+        fields = m_thumb16_table[instruction & 0xFFFF];
     }
 #if 0
     // Debug logging for decode verification
-    if (Log::getInstance().get_log_level() >= LOG_DEBUG) {
+    if (LOG_ENABLED(LOG_DEBUG)) {
         std::stringstream ss;
         if (fields.is_32bit) {
             // For 32-bit instructions, print as two 16-bit halfwords
@@ -144,11 +152,9 @@ InstructionFields Instruction::decode_thumb16_instruction(uint16_t instruction)
     if ((instruction & 0xFC00) == 0x4400) {
         fields.rd = instruction & 0x7;
         fields.rm = (instruction >> 3) & 0x7;
-        fields.h1 = (instruction & 0x80) != 0;
-        fields.h2 = (instruction & 0x40) != 0;
         fields.alu_op = (instruction >> 8) & 0x3;
-        if (fields.h1) fields.rd += 8;
-        if (fields.h2) fields.rm += 8;
+        if (instruction & 0x80) fields.rd += 8; // H1
+        if (instruction & 0x40) fields.rm += 8; // H2
         fields.cond = 0xE; // Unconditional
         switch (fields.alu_op) {
             case 0: fields.type = INST_T16_ADD_HI; break;
@@ -160,7 +166,7 @@ InstructionFields Instruction::decode_thumb16_instruction(uint16_t instruction)
             case 3: 
                 if (instruction & 0x0080) {
                     // BLX not supported in this architecture, treat as undefined
-                    LOG_WARNING("BLX instruction not supported in " ARM_CORE_NAME);
+                    // (the executor warns if it is ever reached)
                     fields.type = INST_UNKNOWN;
                 } else {
                     fields.type = INST_T16_BX;
@@ -440,8 +446,8 @@ InstructionFields Instruction::decode_thumb16_instruction(uint16_t instruction)
     if ((instruction & 0xFF00) == 0xBF00) {
         uint32_t hint_op = instruction & 0xFF;
 
-#if HAS_EXTENDED_HINTS
-        // ARMv7-M extended hints
+#if SUPPORTS_ARMV6_M
+        // Hints are part of ARMv6-M already
         switch (hint_op) {
             case 0x00: fields.type = INST_T16_NOP; break;
             case 0x10: fields.type = INST_T16_YIELD; break;
@@ -1373,7 +1379,9 @@ InstructionFields Instruction::decode_thumb32_instruction(uint32_t instruction)
                 bool p_bit = (instruction & 0x01000000) != 0;  // bit 24
                 bool u_bit = (instruction & 0x00800000) != 0;  // bit 23
                 bool w_bit = (instruction & 0x00200000) != 0;  // bit 21
-                fields.addressing_mode = (p_bit ? 4 : 0) | (u_bit ? 2 : 0) | (w_bit ? 1 : 0);
+                fields.pre_indexed = p_bit;
+                fields.negative_offset = !u_bit;
+                fields.writeback = w_bit;
                 return fields;
             }
             else if ((op1_field & 0x21) == 0x01) { // 0xxxx1: Load Coprocessor
@@ -1391,7 +1399,9 @@ InstructionFields Instruction::decode_thumb32_instruction(uint32_t instruction)
                 bool p_bit = (instruction & 0x01000000) != 0;  // bit 24
                 bool u_bit = (instruction & 0x00800000) != 0;  // bit 23
                 bool w_bit = (instruction & 0x00200000) != 0;  // bit 21
-                fields.addressing_mode = (p_bit ? 4 : 0) | (u_bit ? 2 : 0) | (w_bit ? 1 : 0);
+                fields.pre_indexed = p_bit;
+                fields.negative_offset = !u_bit;
+                fields.writeback = w_bit;
                 return fields;
             }
             else if (op1_field == 0x04) { // 000100: Move to Coprocessor from two ARM core registers
@@ -1720,12 +1730,14 @@ InstructionFields Instruction::decode_thumb32_instruction(uint32_t instruction)
 #if SUPPORTS_ARMV7_M
                 // 0x0 0111010: Hint instructions
                 else if (op_field == 0x3A) {
-                    uint32_t hint_op = (instruction >> 4) & 0xF;  // bits 7:4
+                    uint32_t hint_op = instruction & 0xFF;  // bits 7:0
                     switch (hint_op) {
+                        case 0x1: fields.type = INST_T32_YIELD; break;
+                        case 0x2: fields.type = INST_T32_WFE; break;
+                        case 0x3: fields.type = INST_T32_WFI; break;
                         case 0x4: fields.type = INST_T32_SEV; break;
                         case 0x5: fields.type = INST_T32_SEVL; break;
-                        case 0x6: fields.type = INST_T32_WFE; break;
-                        default:  fields.type = INST_T32_NOP; break;
+                        default:  fields.type = INST_T32_NOP; break;  // NOP, DBG and unallocated hints
                     }
                     return fields;
                 }
@@ -3020,3 +3032,5 @@ bool Instruction::is_32bit_instruction(uint32_t instruction)
            ((first_half & 0xF800) == 0xF000) || 
            ((first_half & 0xF800) == 0xF800);
 }
+
+} // namespace ARM_CORE_NAMESPACE
@@ -3,10 +3,13 @@
 
 #include <systemc>
 #include <cstdint>
+#include <vector>
 #include "ARM_CortexM_Config.h"
 
 using namespace sc_core;
 
+namespace ARM_CORE_NAMESPACE {
+
 // ARMv6-M Thumb instruction types (granular, per A5 encoding)
 // Prefix T16_ for 16-bit Thumb, T32_ for 32-bit Thumb encodings
 enum InstructionType {
@@ -503,33 +506,40 @@ enum InstructionType {
     INST_T32_BXNS,              // BXNS (Branch, Non-Secure)
 #endif
 
+    INST_TYPE_COUNT             // Number of instruction types (not an instruction)
 };
 
 // Instruction fields structure
+// Decoded instruction, packed into 16 bytes so the decode cache and
+// translated blocks stay dense. Small fields are bitfields; members keep
+// their names, so fields.cond, fields.s_bit etc. read as before.
 struct InstructionFields {
     uint32_t opcode;     // Raw instruction (16-bit or 32-bit)
+    union {
+        uint32_t imm;        // Immediate value (extended for 32-bit instructions)
+        uint16_t reg_list;   // Register list for multiple load/store (these have no immediate)
+    };
     uint8_t rd;          // Destination register
     uint8_t rn;          // First operand register  
     uint8_t rm;          // Second operand register
     uint8_t rs;          // Shift register / third operand
-    uint32_t imm;        // Immediate value (extended for 32-bit instructions)
-    uint8_t cond;        // Condition code
-    bool s_bit;          // Set flags bit
-    uint8_t shift_type;  // Shift type (LSL, LSR, ASR, ROR)
-    uint8_t shift_amount; // Shift amount
-    uint8_t alu_op;      // ALU operation code
-    bool h1, h2;         // Hi register flags
-    uint16_t reg_list;   // Register list for multiple load/store
-    bool load_store_bit; // Load (1) or Store (0)
-    uint8_t byte_word;   // Byte (1) or Word (0)
-    bool pre_indexed;    // Pre-indexed (1) or post-indexed (0) addressing
-    bool writeback;      // Writeback to base register
-    bool negative_offset; // Negative offset for immediate addressing
-    bool is_32bit;       // True if 32-bit instruction
-    uint8_t addressing_mode; // Addressing mode for coprocessor instructions
-    InstructionType type;
+    InstructionType type : 9;
+    uint32_t cond : 4;           // Condition code
+    uint32_t shift_type : 2;     // Shift type (LSL, LSR, ASR, ROR)
+    uint32_t shift_amount : 5;   // Shift amount
+    uint32_t alu_op : 4;         // ALU operation code
+    uint32_t byte_word : 2;      // Word (0), byte (1) or halfword (2)
+    bool s_bit : 1;              // Set flags bit
+    bool load_store_bit : 1;     // Load (1) or Store (0)
+    bool pre_indexed : 1;        // Pre-indexed (1) or post-indexed (0) addressing
+    bool writeback : 1;          // Writeback to base register
+    bool negative_offset : 1;    // Negative offset for immediate addressing
+    bool is_32bit : 1;           // True if 32-bit instruction
 };
 
+static_assert(INST_TYPE_COUNT <= (1 << 9), "InstructionFields::type is too narrow");
+static_assert(sizeof(InstructionFields) <= 16, "InstructionFields must stay within 16 bytes");
+
 class Instruction : public sc_module
 {
 public:
@@ -544,6 +554,10 @@ public:
     bool is_32bit_instruction(uint32_t instruction);
     
 private:
+    // Decoded form of every 16-bit encoding, indexed by halfword (built once
+    // in the constructor from decode_thumb16_instruction)
+    std::vector<InstructionFields> m_thumb16_table;
+
     // Core Thumb instruction decoding functions
     InstructionFields decode_thumb16_instruction(uint16_t instruction);
     InstructionFields decode_thumb32_instruction(uint32_t instruction);
@@ -552,4 +566,6 @@ private:
     uint32_t decode_t32_modified_immediate(uint32_t i, uint32_t imm3, uint32_t imm8);
 };
 
+} // namespace ARM_CORE_NAMESPACE
+
 #endif // INSTRUCTION_H
\ No newline at end of file
@@ -1,12 +1,11 @@
 #include "Registers.h"
 #include "Performance.h"
 #include "Log.h"
+#include "Checkpoint.h"
+#include "InstructionTrace.h"
 
 Registers::Registers(sc_module_name name) : 
     sc_module(name),
-    //m_sp(0x20001000),    // Kept for backward compatibility
-    m_lr(0x00000000),
-    m_pc(0x00000000),
     m_psr(0x01000000),   // Default xPSR with Thumb bit set (bit 24)
     m_primask(0x00000000), // Interrupts enabled by default
     m_basepri(0x00000000), // No base priority masking
@@ -14,78 +13,52 @@ Registers::Registers(sc_module_name name) :
     m_control(0x00000000), // Privileged mode, MSP selected
     m_msp(0x20001000),   // Main Stack Pointer - default to top of RAM
     m_psp(0x00000000),    // Process Stack Pointer - initialized to 0
+    m_psp_active(false),  // MSP in R13
     m_it_firstcond(0x00), // No IT block active initially
     m_it_mask(0x00),       // No IT block active initially
     m_it_len(0x00),       // No IT block active initially
     m_it_index(0x00)      // No IT block active initially
 {
-    // Initialize general purpose registers to 0
-    for (int i = 0; i < 13; i++) {
-        m_gpr[i] = 0;
+    // Initialize general purpose registers, LR and PC to 0; R13 is the MSP
+    for (int i = 0; i < 16; i++) {
+        m_r[i] = 0;
     }
+    m_r[13] = m_msp;
     
     LOG_INFO("Registers initialized");
 }
 
-uint32_t Registers::read_register(uint8_t reg_num)
+void Registers::track_access(uint8_t reg_num, uint32_t value, bool write)
 {
-    Performance::getInstance().increment_register_reads();
-    
-    uint32_t value = 0;
-    
-    if (reg_num < 13) {
-        value = m_gpr[reg_num];
-    } else if (reg_num == 13) {
-        value = get_current_sp();  // Use current SP based on CONTROL.SPSEL
-    } else if (reg_num == 14) {
-        value = m_lr;
-    } else if (reg_num == 15) {
-        value = m_pc;
+    if (write) {
+        Performance::getInstance().increment_register_writes();
+        if (m_trace) {
+            m_trace->register_write(reg_num, value);
+        }
     } else {
-        LOG_WARNING("Invalid register number: " + std::to_string(reg_num));
-        return 0;
+        Performance::getInstance().increment_register_reads();
     }
     
-    if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-        Log::getInstance().log_register_access("R" + std::to_string(reg_num), value, false);
+    if (LOG_ENABLED(LOG_TRACE)) {
+        Log::getInstance().log_register_access("R" + std::to_string(reg_num), value, write);
     }
-    
-    return value;
 }
 
-void Registers::write_register(uint8_t reg_num, uint32_t value)
+uint32_t Registers::invalid_register(uint8_t reg_num)
 {
-    Performance::getInstance().increment_register_writes();
-    
-    if (reg_num < 13) {
-        m_gpr[reg_num] = value;
-    } else if (reg_num == 13) {
-        set_current_sp(value);  // Set current SP based on CONTROL.SPSEL
-    } else if (reg_num == 14) {
-        m_lr = value;
-    } else if (reg_num == 15) {
-        m_pc = value & ~1; // Ensure PC is always even (Thumb state)
-    } else {
-        LOG_WARNING("Invalid register number: " + std::to_string(reg_num));
-        return;
-    }
-    
-    if (Log::getInstance().get_log_level() >= LOG_TRACE) {
-        Log::getInstance().log_register_access("R" + std::to_string(reg_num), value, true);
-    }
+    LOG_WARNING("Invalid register number: " + std::to_string(reg_num));
+    return 0;
 }
 
 void Registers::reset()
 {
     // Reset all registers to initial values
-    for (int i = 0; i < 13; i++) {
-        m_gpr[i] = 0;
+    for (int i = 0; i < 16; i++) {
+        m_r[i] = 0;
     }
     
-    //m_sp = 0x20001000;     // Kept for backward compatibility
-    m_lr = 0x00000000;
-    m_pc = 0x00000000;
     m_psr = 0x01000000;    // Default xPSR with Thumb bit set (bit 24)
+    m_flags_op = FLAGS_IN_PSR;
     
     // Reset special registers
     m_primask = 0x00000000; // Interrupts enabled
@@ -94,10 +67,63 @@ void Registers::reset()
     m_control = 0x00000000; // Privileged mode, MSP selected
     m_msp = 0x20001000;     // Main Stack Pointer
     m_psp = 0x00000000;     // Process Stack Pointer
+    m_psp_active = false;
+    m_r[13] = m_msp;
     m_it_firstcond = 0x00;      // No IT block active
     m_it_mask = 0x00;      // No IT block active
     m_it_len = 0x00;      // No IT block active
     m_it_index = 0x00;      // No IT block active
 
     LOG_INFO("Registers reset");
-}
\ No newline at end of file
+}
+
+void Registers::save_state(CheckpointWriter& out) const
+{
+    out.section("REGS");
+    for (int i = 0; i < 13; i++) {
+        out.put_u32(m_r[i]);
+    }
+    out.put_u32(m_r[14]);
+    out.put_u32(m_r[15]);
+    out.put_u32(get_psr());
+    out.put_u32(m_primask);
+    out.put_u32(m_basepri);
+    out.put_u32(m_faultmask);
+    out.put_u32(m_control);
+    out.put_u32(get_msp());
+    out.put_u32(get_psp());
+    out.put_u8(m_it_firstcond);
+    out.put_u8(m_it_mask);
+    out.put_u8(m_it_len);
+    out.put_u8(m_it_index);
+    out.put_u8(m_it_cond_result ? 1 : 0);
+}
+
+bool Registers::restore_state(CheckpointReader& in)
+{
+    if (!in.section("REGS")) {
+        return false;
+    }
+    for (int i = 0; i < 13; i++) {
+        m_r[i] = in.get_u32();
+    }
+    m_r[14] = in.get_u32();
+    m_r[15] = in.get_u32();
+    m_psr = in.get_u32();
+    m_flags_op = FLAGS_IN_PSR;
+    m_primask = in.get_u32();
+    m_basepri = in.get_u32();
+    m_faultmask = in.get_u32();
+    m_control = in.get_u32();
+    // Load MSP into R13, then bank for the restored IPSR/CONTROL
+    m_r[13] = in.get_u32();
+    m_psp = in.get_u32();
+    m_psp_active = false;
+    update_active_sp();
+    m_it_firstcond = in.get_u8();
+    m_it_mask = in.get_u8();
+    m_it_len = in.get_u8();
+    m_it_index = in.get_u8();
+    m_it_cond_result = in.get_u8() != 0;
+    return in.ok();
+}
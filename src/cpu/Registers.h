@@ -6,6 +6,10 @@
 
 using namespace sc_core;
 
+class CheckpointWriter;
+class CheckpointReader;
+class InstructionTrace;
+
 class Registers : public sc_module
 {
 public:
@@ -13,22 +17,50 @@ public:
     SC_HAS_PROCESS(Registers);
     Registers(sc_module_name name);
     
-    // Register access methods
-    uint32_t read_register(uint8_t reg_num);
-    void write_register(uint8_t reg_num, uint32_t value);
+    // Register access methods. R13 always holds the active stack pointer, so
+    // these are plain array accesses on the execution path.
+    uint32_t read_register(uint8_t reg_num) {
+        if (reg_num > 15) {
+            return invalid_register(reg_num);
+        }
+        if (m_track_access) {
+            track_access(reg_num, m_r[reg_num], false);
+        }
+        return m_r[reg_num];
+    }
+    void write_register(uint8_t reg_num, uint32_t value) {
+        if (reg_num > 15) {
+            invalid_register(reg_num);
+            return;
+        }
+        if (reg_num == 15) {
+            value &= ~1u; // Ensure PC is always even (Thumb state)
+        }
+        m_r[reg_num] = value;
+        if (m_track_access) {
+            track_access(reg_num, value, true);
+        }
+    }
+
+    // Count register accesses in Performance and log them at TRACE level.
+    // Off by default: it puts a call on every register access.
+    void set_access_tracking(bool enable) { m_track_access = enable; }
+    // Record register writes in a binary execution trace; needs access tracking
+    void set_trace(InstructionTrace* trace) { m_trace = trace; }
+    bool is_access_tracking() const { return m_track_access; }
     
     // Special register access
-    uint32_t get_pc() const { return m_pc; }
-    void set_pc(uint32_t pc) { m_pc = pc; }
+    uint32_t get_pc() const { return m_r[15]; }
+    void set_pc(uint32_t pc) { m_r[15] = pc; }
     
-    uint32_t get_psr() const { return m_psr; }
-    void set_psr(uint32_t psr) { m_psr = psr; }
+    uint32_t get_psr() const { return (m_psr & 0x0FFFFFFF) | get_nzcv(); }
+    void set_psr(uint32_t psr) { m_psr = psr; m_flags_op = FLAGS_IN_PSR; update_active_sp(); }
     
     uint32_t get_sp() const { return get_current_sp(); }
     void set_sp(uint32_t sp) { set_current_sp(sp); }
     
-    uint32_t get_lr() const { return m_lr; }
-    void set_lr(uint32_t lr) { m_lr = lr; }
+    uint32_t get_lr() const { return m_r[14]; }
+    void set_lr(uint32_t lr) { m_r[14] = lr; }
     
     // Special register access for ARM Cortex-M
     uint32_t get_primask() const { return m_primask; }
@@ -41,34 +73,20 @@ public:
     void set_faultmask(uint32_t faultmask) { m_faultmask = faultmask & 0x1; }  // Only bit 0 is valid
     
     uint32_t get_control() const { return m_control; }
-    void set_control(uint32_t control) { m_control = control & 0x3; }  // Only bits 1-0 are valid
+    void set_control(uint32_t control) { m_control = control & 0x3; update_active_sp(); }  // Only bits 1-0 are valid
     
-    // Stack pointer management (MSP/PSP based on CONTROL.SPSEL)
-    uint32_t get_msp() const { return m_msp; }
-    void set_msp(uint32_t msp) { m_msp = msp; }
+    // Stack pointer management (MSP/PSP based on CONTROL.SPSEL). The active
+    // one lives in R13; the other is banked in m_msp/m_psp.
+    uint32_t get_msp() const { return m_psp_active ? m_msp : m_r[13]; }
+    void set_msp(uint32_t msp) { (m_psp_active ? m_msp : m_r[13]) = msp; }
     
-    uint32_t get_psp() const { return m_psp; }
-    void set_psp(uint32_t psp) { m_psp = psp; }
+    uint32_t get_psp() const { return m_psp_active ? m_r[13] : m_psp; }
+    void set_psp(uint32_t psp) { (m_psp_active ? m_r[13] : m_psp) = psp; }
     
     // Current stack pointer selection
     // In Handler mode (IPSR != 0), SP always refers to MSP regardless of CONTROL.SPSEL (ARMv7-M)
-    uint32_t get_current_sp() const {
-        if (is_in_exception()) {
-            return m_msp;
-        }
-        return (m_control & 0x2) ? m_psp : m_msp;
-    }
-    void set_current_sp(uint32_t sp) {
-        if (is_in_exception()) {
-            m_msp = sp;
-            return;
-        }
-        if (m_control & 0x2) {
-            m_psp = sp;
-        } else {
-            m_msp = sp;
-        }
-    }
+    uint32_t get_current_sp() const { return m_r[13]; }
+    void set_current_sp(uint32_t sp) { m_r[13] = sp; }
     
     // Interrupt masking state
     bool interrupts_enabled() const { return (m_primask & 0x1) == 0; }
@@ -85,23 +103,67 @@ public:
         }
     }
     
+    // Lazy NZCV. Flag-setting instructions only record their result (and, for
+    // add/subtract, the operands); the flags are computed when something reads
+    // them: a condition check, IT, MRS, exception entry or the debugger.
+    // Subtraction is recorded as a + ~b + 1, SBC as a + ~b + C.
+    void set_flags_add(uint32_t a, uint32_t b, uint32_t carry_in, uint32_t result) {
+        m_flags_op = FLAGS_ADD;
+        m_flags_a = a;
+        m_flags_b = b;
+        m_flags_carry_in = carry_in;
+        m_flags_result = result;
+    }
+    // N and Z from result, C and V given
+    void set_flags_result(uint32_t result, bool carry, bool overflow) {
+        m_flags_op = FLAGS_RESULT;
+        m_flags_result = result;
+        m_flags_cv = (carry ? 0x20000000u : 0) | (overflow ? 0x10000000u : 0);
+    }
+    // Current NZCV in bits 31-28
+    uint32_t get_nzcv() const {
+        switch (m_flags_op) {
+            case FLAGS_ADD: {
+                uint32_t carry = static_cast<uint32_t>((static_cast<uint64_t>(m_flags_a) + m_flags_b + m_flags_carry_in) >> 32);
+                uint32_t overflow = ((m_flags_a ^ m_flags_result) & (m_flags_b ^ m_flags_result)) >> 31;
+                return (m_flags_result & 0x80000000u) | (m_flags_result == 0 ? 0x40000000u : 0) |
+                       (carry << 29) | (overflow << 28);
+            }
+            case FLAGS_RESULT:
+                return (m_flags_result & 0x80000000u) | (m_flags_result == 0 ? 0x40000000u : 0) | m_flags_cv;
+            default:
+                return m_psr & 0xF0000000u;
+        }
+    }
+    // Fold pending flags into m_psr before a partial update
+    void materialize_flags() {
+        if (m_flags_op != FLAGS_IN_PSR) {
+            m_psr = (m_psr & 0x0FFFFFFF) | get_nzcv();
+            m_flags_op = FLAGS_IN_PSR;
+        }
+    }
+
     // PSR flag access (APSR - Application Program Status Register)
-    bool get_n_flag() const { return (m_psr >> 31) & 1; }
-    bool get_z_flag() const { return (m_psr >> 30) & 1; }
-    bool get_c_flag() const { return (m_psr >> 29) & 1; }
-    bool get_v_flag() const { return (m_psr >> 28) & 1; }
+    bool get_n_flag() const { return (get_nzcv() >> 31) & 1; }
+    bool get_z_flag() const { return (get_nzcv() >> 30) & 1; }
+    bool get_c_flag() const { return (get_nzcv() >> 29) & 1; }
+    bool get_v_flag() const { return (get_nzcv() >> 28) & 1; }
     bool get_q_flag() const { return (m_psr >> 27) & 1; }  // Saturation flag
     
     void set_n_flag(bool flag) { 
+        materialize_flags();
         m_psr = (m_psr & ~(1U << 31)) | (flag ? (1U << 31) : 0); 
     }
     void set_z_flag(bool flag) { 
+        materialize_flags();
         m_psr = (m_psr & ~(1U << 30)) | (flag ? (1U << 30) : 0); 
     }
     void set_c_flag(bool flag) { 
+        materialize_flags();
         m_psr = (m_psr & ~(1U << 29)) | (flag ? (1U << 29) : 0); 
     }
     void set_v_flag(bool flag) { 
+        materialize_flags();
         m_psr = (m_psr & ~(1U << 28)) | (flag ? (1U << 28) : 0); 
     }
     void set_q_flag(bool flag) { 
@@ -112,6 +174,7 @@ public:
     uint32_t get_ipsr() const { return m_psr & 0x1FF; }
     void set_ipsr(uint32_t exception_num) { 
         m_psr = (m_psr & ~0x1FF) | (exception_num & 0x1FF);
+        update_active_sp();
     }
     
     // EPSR access (Execution Program Status Register) - bit 24 (Thumb)
@@ -121,10 +184,11 @@ public:
     }
     
     // Combined xPSR access methods
-    uint32_t get_apsr() const { return m_psr & 0xF8000000; }  // N, Z, C, V, Q flags
+    uint32_t get_apsr() const { return (m_psr & 0x08000000) | get_nzcv(); }  // N, Z, C, V, Q flags
     uint32_t get_epsr() const { return m_psr & 0x01000000; }  // Thumb bit
     void set_apsr(uint32_t apsr) { 
         m_psr = (m_psr & ~0xF8000000) | (apsr & 0xF8000000);
+        m_flags_op = FLAGS_IN_PSR;
     }
     void set_epsr(uint32_t epsr) { 
         m_psr = (m_psr & ~0x01000000) | (epsr & 0x01000000);
@@ -199,21 +263,39 @@ public:
     // Reset
     void reset();
 
+    // Checkpoint support
+    void save_state(CheckpointWriter& out) const;
+    bool restore_state(CheckpointReader& in);
+
 private:
-    // ARM Cortex-M0 registers (R0-R12)
-    uint32_t m_gpr[13];  // General Purpose Registers R0-R12
-    //uint32_t m_sp;       // Stack Pointer (R13) - deprecated, use m_msp/m_psp
-    uint32_t m_lr;       // Link Register (R14)  
-    uint32_t m_pc;       // Program Counter (R15)
-    uint32_t m_psr;      // Program Status Register (xPSR)
+    // R0-R12, active SP (R13), LR (R14) and PC (R15)
+    uint32_t m_r[16];
+    uint32_t m_psr;      // Program Status Register (xPSR); NZCV only while m_flags_op is FLAGS_IN_PSR
+
+    // Lazy flag state
+    enum FlagsOp : uint8_t {
+        FLAGS_IN_PSR = 0,    // NZCV are in m_psr
+        FLAGS_ADD,           // m_flags_a + m_flags_b + m_flags_carry_in = m_flags_result
+        FLAGS_RESULT         // N/Z from m_flags_result, C/V in m_flags_cv
+    };
+    FlagsOp m_flags_op { FLAGS_IN_PSR };
+    uint32_t m_flags_a { 0 };
+    uint32_t m_flags_b { 0 };
+    uint32_t m_flags_carry_in { 0 };
+    uint32_t m_flags_result { 0 };
+    uint32_t m_flags_cv { 0 };
     
     // ARM Cortex-M special registers
     uint32_t m_primask;  // PRIMASK - interrupt mask
     uint32_t m_basepri;  // BASEPRI - base priority register
     uint32_t m_faultmask; // FAULTMASK - fault mask register
     uint32_t m_control;  // CONTROL - privilege level and stack selection
-    uint32_t m_msp;      // Main Stack Pointer
-    uint32_t m_psp;      // Process Stack Pointer
+    uint32_t m_msp;      // Main Stack Pointer (banked; live in R13 while !m_psp_active)
+    uint32_t m_psp;      // Process Stack Pointer (banked; live in R13 while m_psp_active)
+    bool m_psp_active;   // R13 holds PSP: Thread mode with CONTROL.SPSEL set
+
+    bool m_track_access { false };
+    InstructionTrace* m_trace { nullptr };
     
     // IT (If-Then) block state (ARMv7-M)
     uint8_t m_it_firstcond; // IT firstcond
@@ -221,6 +303,25 @@ private:
     uint8_t m_it_len;     // Number of instructions in IT block (1..4)
     uint8_t m_it_index;   // Current instruction index within IT block
     bool m_it_cond_result; // Condition result evaluated when IT block started
+
+    // Swap MSP/PSP through R13 when IPSR or CONTROL.SPSEL changes the active stack
+    void update_active_sp() {
+        bool psp = !is_in_exception() && (m_control & 0x2);
+        if (psp == m_psp_active) {
+            return;
+        }
+        if (psp) {
+            m_msp = m_r[13];
+            m_r[13] = m_psp;
+        } else {
+            m_psp = m_r[13];
+            m_r[13] = m_msp;
+        }
+        m_psp_active = psp;
+    }
+
+    void track_access(uint8_t reg_num, uint32_t value, bool write);
+    uint32_t invalid_register(uint8_t reg_num);
 };
 
 #endif // REGISTERS_H
\ No newline at end of file
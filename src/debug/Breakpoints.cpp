@@ -0,0 +1,103 @@
+#include "Breakpoints.h"
+#include <algorithm>
+
+Breakpoints::Breakpoints() :
+    m_set(nullptr),
+    m_generation(0)
+{
+}
+
+Breakpoints::~Breakpoints()
+{
+    delete m_set.load();
+    for (const Set* set : m_retired) {
+        delete set;
+    }
+}
+
+void Breakpoints::insert(uint32_t address)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (address != EMPTY && std::find(m_addresses.begin(), m_addresses.end(), address) == m_addresses.end()) {
+        m_addresses.push_back(address);
+        publish();
+    }
+}
+
+void Breakpoints::remove(uint32_t address)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find(m_addresses.begin(), m_addresses.end(), address);
+    if (it != m_addresses.end()) {
+        m_addresses.erase(it);
+        publish();
+    }
+}
+
+void Breakpoints::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_addresses.empty()) {
+        m_addresses.clear();
+        publish();
+    }
+}
+
+bool Breakpoints::has(uint32_t address) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::find(m_addresses.begin(), m_addresses.end(), address) != m_addresses.end();
+}
+
+bool Breakpoints::first_in_range(uint32_t start, uint32_t end, uint32_t& address) const
+{
+    const Set* set = m_set.load(std::memory_order_acquire);
+    if (!set) {
+        return false;
+    }
+    auto it = std::lower_bound(set->sorted.begin(), set->sorted.end(), start);
+    if (it == set->sorted.end() || *it >= end) {
+        return false;
+    }
+    address = *it;
+    return true;
+}
+
+void Breakpoints::reclaim()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const Set* set : m_retired) {
+        delete set;
+    }
+    m_retired.clear();
+}
+
+void Breakpoints::publish()
+{
+    // Called with m_mutex held
+    Set* set = nullptr;
+    if (!m_addresses.empty()) {
+        set = new Set();
+        set->bits = 3;
+        while ((1u << set->bits) < m_addresses.size() * 2) {
+            set->bits++;
+        }
+        set->mask = (1u << set->bits) - 1;
+        set->slots.assign(set->mask + 1, EMPTY);
+        for (uint32_t address : m_addresses) {
+            uint32_t i = hash(address, set->bits);
+            while (set->slots[i] != EMPTY) {
+                i = (i + 1) & set->mask;
+            }
+            set->slots[i] = address;
+        }
+        set->sorted = m_addresses;
+        std::sort(set->sorted.begin(), set->sorted.end());
+    }
+
+    const Set* old = m_set.exchange(set, std::memory_order_acq_rel);
+    if (old) {
+        m_retired.push_back(old);
+    }
+    m_generation.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,80 @@
+#ifndef BREAKPOINTS_H
+#define BREAKPOINTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// GDB software breakpoints, as seen by the CPU. The GDB server thread edits
+// them; the CPU thread looks them up before every instruction without
+// taking a lock.
+//
+// Every change publishes a new immutable set (a small open-addressing hash
+// table plus a sorted copy for range queries) through one atomic pointer.
+// Replaced sets are kept until the CPU calls reclaim() between lookups,
+// which it does whenever it stops for the debugger. Lookups and reclaim()
+// must come from the same (CPU) thread.
+class Breakpoints
+{
+public:
+    Breakpoints();
+    ~Breakpoints();
+
+    // Server side
+    void insert(uint32_t address);
+    void remove(uint32_t address);
+    void clear();
+    bool has(uint32_t address) const;
+
+    // CPU side: one load when there are no breakpoints, else a hash probe
+    bool contains(uint32_t address) const {
+        const Set* set = m_set.load(std::memory_order_acquire);
+        if (!set) {
+            return false;
+        }
+        for (uint32_t i = hash(address, set->bits); ; i = (i + 1) & set->mask) {
+            uint32_t slot = set->slots[i];
+            if (slot == address) {
+                return true;
+            }
+            if (slot == EMPTY) {
+                return false;
+            }
+        }
+    }
+
+    // Lowest breakpoint address in [start, end); false if there is none
+    bool first_in_range(uint32_t start, uint32_t end, uint32_t& address) const;
+
+    // Bumped on every change, so cached per-block answers can be revalidated
+    uint32_t generation() const { return m_generation.load(std::memory_order_acquire); }
+
+    // Free sets replaced since the last call (CPU thread only)
+    void reclaim();
+
+private:
+    // Thumb code is halfword aligned, so no breakpoint sits at this address
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+    struct Set {
+        std::vector<uint32_t> slots;    // Power-of-two hash table, EMPTY = free
+        std::vector<uint32_t> sorted;
+        uint32_t mask;
+        unsigned bits;
+    };
+
+    static uint32_t hash(uint32_t address, unsigned bits) {
+        return (address * 2654435761u) >> (32 - bits);
+    }
+
+    mutable std::mutex m_mutex;         // Serializes editors and reclaim()
+    std::vector<uint32_t> m_addresses;  // Editor copy
+    std::atomic<const Set*> m_set;      // Published set; nullptr when empty
+    std::vector<const Set*> m_retired;  // Replaced, possibly still being read
+    std::atomic<uint32_t> m_generation;
+
+    void publish();
+};
+
+#endif // BREAKPOINTS_H
@@ -1,5 +1,6 @@
 #include "GDBServer.h"
-#include "CPU.h"
+#include "CPUCore.h"
+#include "Breakpoints.h"
 #include "Registers.h"
 #include "Log.h"
 #include <sys/socket.h>
@@ -575,13 +576,14 @@ std::string GDBServer::handle_step()
 
 std::string GDBServer::handle_breakpoint(const std::string& packet)
 {
-    // Format: Z0,addr,kind or z0,addr,kind
+    // Format: Ztype,addr,kind or ztype,addr,kind
     if (packet.length() < 5) return "E01";
     
     bool insert = (packet[0] == 'Z');
     char type = packet[1];
     
-    if (type != '0') return ""; // Only software breakpoints supported
+    // Software breakpoints and write/read/access watchpoints
+    if (type != '0' && type != '2' && type != '3' && type != '4') return "";
     
     size_t comma1 = packet.find(',', 2);
     size_t comma2 = packet.find(',', comma1 + 1);
@@ -592,10 +594,26 @@ std::string GDBServer::handle_breakpoint(const std::string& packet)
     
     uint32_t address = parse_hex(packet.substr(comma1 + 1, comma2 - comma1 - 1));
     
+    if (!m_cpu) {
+        return "E01";
+    }
+
+    if (type != '0') {
+        // For watchpoints, kind is the length of the watched range
+        size_t end = packet.find(';', comma2 + 1);
+        uint32_t length = parse_hex(packet.substr(comma2 + 1, end == std::string::npos ? std::string::npos : end - comma2 - 1));
+        Watchpoints::Type watch_type = static_cast<Watchpoints::Type>(type - '0');
+        Watchpoints& watchpoints = m_cpu->get_watchpoints();
+        bool ok = insert ? watchpoints.insert(watch_type, address, length)
+                         : watchpoints.remove(watch_type, address, length);
+        return ok ? "OK" : "E01";
+    }
+    
+    // Breakpoints live on the CPU side, which looks them up without locking
     if (insert) {
-        m_breakpoints[address] = true;
+        m_cpu->get_breakpoints().insert(address);
     } else {
-        m_breakpoints.erase(address);
+        m_cpu->get_breakpoints().remove(address);
     }
     
     return "OK";
@@ -667,6 +685,15 @@ void GDBServer::notify_step_complete()
     }
 }
 
+void GDBServer::notify_watchpoint(Watchpoints::Type type, uint32_t address)
+{
+    if (m_client_connected) {
+        const char* kind = type == Watchpoints::WATCH_WRITE ? "watch" :
+                           type == Watchpoints::WATCH_READ ? "rwatch" : "awatch";
+        send_packet(std::string("T05") + kind + ":" + to_hex(address) + ";");
+    }
+}
+
 void GDBServer::wait_for_continue()
 {
     if (!m_debug_mode || !m_server_running) {
@@ -686,7 +713,7 @@ void GDBServer::wait_for_continue()
 
 bool GDBServer::has_breakpoint(uint32_t address) const
 {
-    return m_breakpoints.find(address) != m_breakpoints.end();
+    return m_cpu && m_cpu->get_breakpoints().has(address);
 }
 
 bool GDBServer::wait_for_connection(int timeout_ms)
@@ -4,17 +4,17 @@
 #include <systemc>
 #include <string>
 #include <vector>
-#include <map>
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <cstdint>
+#include "Watchpoints.h"
 
 using namespace sc_core;
 
 // Forward declarations
-class CPU;
+class CPUCore;
 class Registers;
 class Memory;
 
@@ -30,7 +30,7 @@ public:
     ~GDBServer();
     
     // Set CPU reference for debugging
-    void set_cpu(CPU* cpu) { m_cpu = cpu; }
+    void set_cpu(CPUCore* cpu) { m_cpu = cpu; }
     
     // Server control
     void start_server();
@@ -41,6 +41,7 @@ public:
     // Debug control interface
     void notify_breakpoint();
     void notify_step_complete();
+    void notify_watchpoint(Watchpoints::Type type, uint32_t address);
     void wait_for_continue();
     bool has_breakpoint(uint32_t address) const;
     
@@ -57,12 +58,11 @@ private:
     std::atomic<bool> m_debug_mode;
     std::atomic<bool> m_single_step;
     std::atomic<bool> m_continue_requested;
-    std::map<uint32_t, bool> m_breakpoints;
     std::mutex m_debug_mutex;
     std::condition_variable m_continue_cv;
     
     // CPU reference
-    CPU* m_cpu;
+    CPUCore* m_cpu;
     
     // GDB Protocol methods
     void server_thread();
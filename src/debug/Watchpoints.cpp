@@ -0,0 +1,103 @@
+#include "Watchpoints.h"
+
+Watchpoints::Watchpoints() :
+    m_count(0),
+    m_hit(false),
+    m_hit_type(WATCH_ACCESS),
+    m_hit_address(0)
+{
+    for (auto& word : m_filter) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool Watchpoints::insert(Type type, uint32_t address, uint32_t length)
+{
+    if (length == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_watches.push_back({ type, address, length });
+    rebuild_filter();
+    return true;
+}
+
+bool Watchpoints::remove(Type type, uint32_t address, uint32_t length)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_watches.begin(); it != m_watches.end(); ++it) {
+        if (it->type == type && it->address == address && it->length == length) {
+            m_watches.erase(it);
+            rebuild_filter();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Watchpoints::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_watches.clear();
+    rebuild_filter();
+    m_hit = false;
+}
+
+bool Watchpoints::take_hit(Type& type, uint32_t& address)
+{
+    if (!m_hit.load(std::memory_order_acquire)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    type = m_hit_type;
+    address = m_hit_address;
+    m_hit = false;
+    return true;
+}
+
+bool Watchpoints::match(uint32_t address, uint32_t size, bool write)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t access_end = static_cast<uint64_t>(address) + size;
+    for (const Watch& watch : m_watches) {
+        if (watch.type == (write ? WATCH_READ : WATCH_WRITE)) {
+            continue;
+        }
+        uint64_t watch_end = static_cast<uint64_t>(watch.address) + watch.length;
+        if (address < watch_end && watch.address < access_end) {
+            // GDB wants the watched address, not the access address
+            if (!m_hit) {
+                m_hit_type = watch.type;
+                m_hit_address = watch.address;
+                m_hit.store(true, std::memory_order_release);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void Watchpoints::rebuild_filter()
+{
+    // Called with m_mutex held. Readers see the old or new filter word by
+    // word; a stale bit only costs one extra match() call.
+    uint64_t filter[FILTER_BITS / 64] = {};
+    for (const Watch& watch : m_watches) {
+        uint32_t first = watch.address >> GRANULE_BITS;
+        uint32_t last = static_cast<uint32_t>((static_cast<uint64_t>(watch.address) + watch.length - 1) >> GRANULE_BITS);
+        if (last - first >= FILTER_BITS) {
+            for (auto& word : filter) {
+                word = ~0ull;
+            }
+            break;
+        }
+        for (uint32_t granule = first; granule != last + 1; ++granule) {
+            uint32_t bit = granule & (FILTER_BITS - 1);
+            filter[bit / 64] |= 1ull << (bit % 64);
+        }
+    }
+    for (uint32_t i = 0; i < FILTER_BITS / 64; ++i) {
+        m_filter[i].store(filter[i], std::memory_order_relaxed);
+    }
+    m_count.store(static_cast<uint32_t>(m_watches.size()), std::memory_order_release);
+}
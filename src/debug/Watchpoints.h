@@ -0,0 +1,74 @@
+#ifndef WATCHPOINTS_H
+#define WATCHPOINTS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// GDB data watchpoints (Z2 write, Z3 read, Z4 access). Set and cleared from
+// the GDB server thread, checked by the CPU on every data access.
+//
+// Normal runs pay one relaxed load (armed()). With watchpoints set, accesses
+// are first tested against a 4096-bit filter of 64-byte granules (folded
+// every 256KB); only filter hits take the lock and compare ranges, so code
+// working on unwatched memory keeps its DMI fast path.
+class Watchpoints
+{
+public:
+    enum Type {
+        WATCH_WRITE = 2,    // Z2
+        WATCH_READ = 3,     // Z3
+        WATCH_ACCESS = 4    // Z4
+    };
+
+    Watchpoints();
+
+    bool insert(Type type, uint32_t address, uint32_t length);
+    bool remove(Type type, uint32_t address, uint32_t length);
+    void clear();
+
+    bool armed() const { return m_count.load(std::memory_order_relaxed) != 0; }
+
+    // Called after a data access once armed() is true; on a match the hit is
+    // latched for take_hit() and true is returned
+    bool check(uint32_t address, uint32_t size, bool write) {
+        uint32_t first = address >> GRANULE_BITS;
+        uint32_t last = (address + size - 1) >> GRANULE_BITS;
+        if (filtered(first) || (last != first && filtered(last))) {
+            return match(address, size, write);
+        }
+        return false;
+    }
+
+    // The first watchpoint hit since the last call, if any
+    bool take_hit(Type& type, uint32_t& address);
+
+private:
+    static const unsigned GRANULE_BITS = 6;
+    static const uint32_t FILTER_BITS = 4096;
+
+    struct Watch {
+        Type type;
+        uint32_t address;
+        uint32_t length;
+    };
+
+    std::mutex m_mutex;
+    std::vector<Watch> m_watches;
+    std::atomic<uint64_t> m_filter[FILTER_BITS / 64];
+    std::atomic<uint32_t> m_count;
+
+    std::atomic<bool> m_hit;
+    Type m_hit_type;
+    uint32_t m_hit_address;
+
+    bool filtered(uint32_t granule) const {
+        granule &= FILTER_BITS - 1;
+        return (m_filter[granule / 64].load(std::memory_order_relaxed) >> (granule % 64)) & 1;
+    }
+    bool match(uint32_t address, uint32_t size, bool write);
+    void rebuild_filter();
+};
+
+#endif // WATCHPOINTS_H
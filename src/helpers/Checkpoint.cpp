@@ -0,0 +1,97 @@
+#include "Checkpoint.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+const char CHECKPOINT_MAGIC[8] = { 'A', 'R', 'M', 'T', 'L', 'M', 'C', 'K' };
+const uint32_t CHECKPOINT_VERSION = 2;  // 2: UART section
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& filename) :
+    m_file(filename, std::ios::binary | std::ios::trunc)
+{
+    m_file.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    put_u32(CHECKPOINT_VERSION);
+}
+
+void CheckpointWriter::put_u32(uint32_t value)
+{
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+    put_bytes(bytes, sizeof(bytes));
+}
+
+void CheckpointWriter::put_u64(uint64_t value)
+{
+    put_u32(static_cast<uint32_t>(value));
+    put_u32(static_cast<uint32_t>(value >> 32));
+}
+
+void CheckpointWriter::put_string(const std::string& value)
+{
+    put_u32(static_cast<uint32_t>(value.size()));
+    put_bytes(value.data(), value.size());
+}
+
+CheckpointReader::CheckpointReader(const std::string& filename) :
+    m_file(filename, std::ios::binary),
+    m_ok(false)
+{
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    if (m_file.read(magic, sizeof(magic)) && std::memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0) {
+        m_ok = true;  // get_u32() only reads while ok
+        m_ok = get_u32() == CHECKPOINT_VERSION;
+    }
+}
+
+bool CheckpointReader::section(const char tag[4])
+{
+    char found[4];
+    if (!get_bytes(found, sizeof(found)) || std::memcmp(found, tag, sizeof(found)) != 0) {
+        m_ok = false;
+    }
+    return m_ok;
+}
+
+uint8_t CheckpointReader::get_u8()
+{
+    uint8_t value = 0;
+    get_bytes(&value, 1);
+    return value;
+}
+
+uint32_t CheckpointReader::get_u32()
+{
+    uint8_t bytes[4] = { 0 };
+    get_bytes(bytes, sizeof(bytes));
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+uint64_t CheckpointReader::get_u64()
+{
+    uint64_t low = get_u32();
+    uint64_t high = get_u32();
+    return low | (high << 32);
+}
+
+bool CheckpointReader::get_bytes(void* data, size_t size)
+{
+    if (m_ok && !m_file.read(static_cast<char*>(data), size)) {
+        m_ok = false;
+    }
+    return m_ok;
+}
+
+std::string CheckpointReader::get_string()
+{
+    uint32_t size = get_u32();
+    if (!m_ok || size > (1u << 20)) {
+        m_ok = false;
+        return std::string();
+    }
+    std::vector<char> buffer(size);
+    get_bytes(buffer.data(), size);
+    return std::string(buffer.begin(), buffer.end());
+}
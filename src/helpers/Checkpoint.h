@@ -0,0 +1,49 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Binary checkpoint stream. A file is the magic/version header followed by
+// one tagged section per component, written and read back in the same order.
+// Values are little-endian.
+class CheckpointWriter
+{
+public:
+    explicit CheckpointWriter(const std::string& filename);
+
+    bool ok() const { return static_cast<bool>(m_file); }
+
+    void section(const char tag[4]) { m_file.write(tag, 4); }
+    void put_u8(uint8_t value) { m_file.put(static_cast<char>(value)); }
+    void put_u32(uint32_t value);
+    void put_u64(uint64_t value);
+    void put_bytes(const void* data, size_t size) { m_file.write(static_cast<const char*>(data), size); }
+    void put_string(const std::string& value);
+
+private:
+    std::ofstream m_file;
+};
+
+class CheckpointReader
+{
+public:
+    explicit CheckpointReader(const std::string& filename);
+
+    // Goes false on the first short read or section mismatch and stays false
+    bool ok() const { return m_ok; }
+
+    bool section(const char tag[4]);
+    uint8_t get_u8();
+    uint32_t get_u32();
+    uint64_t get_u64();
+    bool get_bytes(void* data, size_t size);
+    std::string get_string();
+
+private:
+    std::ifstream m_file;
+    bool m_ok;
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,147 @@
+#include "Compression.h"
+#include <cstring>
+
+namespace {
+
+// Stream format: a sequence is a token byte (literal count in the high
+// nibble, match length - MIN_MATCH in the low nibble, 15 meaning "more
+// length bytes follow"), the literals, then a 16-bit little-endian match
+// offset. The last sequence carries literals only.
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 0xFFFF;
+constexpr unsigned HASH_BITS = 12;
+
+inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash32(uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void put_length(std::vector<uint8_t>& out, size_t length)
+{
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+void put_sequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literal_count,
+                  size_t offset, size_t match_length)
+{
+    size_t match_code = match_length ? match_length - MIN_MATCH : 0;
+    uint8_t token = static_cast<uint8_t>(((literal_count < 15 ? literal_count : 15) << 4) |
+                                         (match_code < 15 ? match_code : 15));
+    out.push_back(token);
+    if (literal_count >= 15) {
+        put_length(out, literal_count - 15);
+    }
+    out.insert(out.end(), literals, literals + literal_count);
+    if (match_length) {
+        out.push_back(static_cast<uint8_t>(offset));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+        if (match_code >= 15) {
+            put_length(out, match_code - 15);
+        }
+    }
+}
+
+bool get_length(const uint8_t*& ip, const uint8_t* end, size_t& length)
+{
+    uint8_t b;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+} // namespace
+
+void Compression::compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+    int32_t table[1u << HASH_BITS];
+    for (auto& slot : table) {
+        slot = -1;
+    }
+
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + MIN_MATCH <= size) {
+        uint32_t h = hash32(read32(data + pos));
+        int32_t candidate = table[h];
+        table[h] = static_cast<int32_t>(pos);
+
+        if (candidate >= 0 && pos - candidate <= MAX_OFFSET &&
+            read32(data + candidate) == read32(data + pos)) {
+            size_t length = MIN_MATCH;
+            while (pos + length < size && data[candidate + length] == data[pos + length]) {
+                ++length;
+            }
+            put_sequence(out, data + anchor, pos - anchor, pos - candidate, length);
+            pos += length;
+            anchor = pos;
+        } else {
+            ++pos;
+        }
+    }
+    put_sequence(out, data + anchor, size - anchor, 0, 0);
+}
+
+bool Compression::decompress(const uint8_t* data, size_t size, uint8_t* out, size_t out_size)
+{
+    const uint8_t* ip = data;
+    const uint8_t* end = data + size;
+    uint8_t* op = out;
+    uint8_t* op_end = out + out_size;
+
+    while (ip < end) {
+        uint8_t token = *ip++;
+
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !get_length(ip, end, literal_count)) {
+            return false;
+        }
+        if (literal_count > static_cast<size_t>(end - ip) || literal_count > static_cast<size_t>(op_end - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literal_count);
+        ip += literal_count;
+        op += literal_count;
+
+        if (ip == end) {
+            break;  // Final literal-only sequence
+        }
+
+        if (end - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && !get_length(ip, end, match_length)) {
+            return false;
+        }
+        match_length += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<size_t>(op - out) ||
+            match_length > static_cast<size_t>(op_end - op)) {
+            return false;
+        }
+        // Byte copy: the match may overlap the bytes being produced
+        const uint8_t* match = op - offset;
+        for (size_t i = 0; i < match_length; ++i) {
+            op[i] = match[i];
+        }
+        op += match_length;
+    }
+    return op == op_end;
+}
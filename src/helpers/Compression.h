@@ -0,0 +1,19 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Small LZ77 byte compressor (LZ4-style sequences) for checkpoint pages and
+// trace files. Favors speed over ratio and needs no external library.
+class Compression
+{
+public:
+    // Append the compressed form of data to out
+    static void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    // Decompress exactly out_size bytes; false on corrupt input
+    static bool decompress(const uint8_t* data, size_t size, uint8_t* out, size_t out_size);
+};
+
+#endif // COMPRESSION_H
@@ -0,0 +1,79 @@
+#include "InstructionTrace.h"
+#include "Compression.h"
+
+namespace {
+
+const char MAGIC[4] = { 'A', 'T', 'R', 'C' };
+const uint8_t VERSION = 1;
+const uint8_t FLAG_COMPRESSED = 0x01;
+
+void put_u32(std::ofstream& file, uint32_t value)
+{
+    char bytes[4] = { static_cast<char>(value), static_cast<char>(value >> 8),
+                      static_cast<char>(value >> 16), static_cast<char>(value >> 24) };
+    file.write(bytes, sizeof(bytes));
+}
+
+} // namespace
+
+InstructionTrace::InstructionTrace() :
+    m_compress(false),
+    m_next_pc(0),
+    m_last_address(0),
+    m_instructions(0)
+{
+}
+
+InstructionTrace::~InstructionTrace()
+{
+    close();
+}
+
+bool InstructionTrace::open(const std::string& path, bool compress)
+{
+    close();
+    m_file.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_file) {
+        return false;
+    }
+    m_compress = compress;
+    m_block.reserve(BLOCK_SIZE + 32);
+    m_opcodes.clear();
+    m_next_pc = 0;
+    m_last_address = 0;
+    m_instructions = 0;
+
+    m_file.write(MAGIC, sizeof(MAGIC));
+    m_file.put(static_cast<char>(VERSION));
+    m_file.put(static_cast<char>(compress ? FLAG_COMPRESSED : 0));
+    return static_cast<bool>(m_file);
+}
+
+void InstructionTrace::close()
+{
+    if (m_file.is_open()) {
+        flush_block();
+        m_file.close();
+    }
+}
+
+void InstructionTrace::flush_block()
+{
+    if (m_block.empty() || !m_file.is_open()) {
+        m_block.clear();
+        return;
+    }
+    const std::vector<uint8_t>* payload = &m_block;
+    if (m_compress) {
+        m_packed.clear();
+        Compression::compress(m_block.data(), m_block.size(), m_packed);
+        // Incompressible blocks are stored as is (stored size == raw size)
+        if (m_packed.size() < m_block.size()) {
+            payload = &m_packed;
+        }
+    }
+    put_u32(m_file, static_cast<uint32_t>(m_block.size()));
+    put_u32(m_file, static_cast<uint32_t>(payload->size()));
+    m_file.write(reinterpret_cast<const char*>(payload->data()), payload->size());
+    m_block.clear();
+}
@@ -0,0 +1,128 @@
+#ifndef INSTRUCTION_TRACE_H
+#define INSTRUCTION_TRACE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compact binary execution trace. Every executed instruction is one record,
+// followed by the register writes, memory accesses and exception entries it
+// caused. tools/trace_decode.py expands a trace back to text.
+//
+// File: "ATRC", version byte, flags byte (bit 0: compressed), then blocks of
+// u32 raw size, u32 stored size (little-endian) and the payload. A block is
+// stored as is when stored size == raw size, otherwise it is compressed with
+// Compression. Records never straddle blocks; decoder state (last PC, known
+// opcodes, last memory address) carries over from block to block.
+//
+// Records start with a tag byte; numbers are LEB128 varints, signed deltas
+// are zigzag encoded:
+//   0x00            next instruction at the expected PC (previous PC + length)
+//   0x01 d          known instruction at expected PC + d
+//   0x02 d op       instruction not seen at this PC before, 16-bit opcode
+//   0x03 d op       same, 32-bit opcode (first halfword in the upper 16 bits)
+//   0x04 n          exception n taken
+//   0x10+r v        register r written with v
+//   0x20+k d v      memory access at last address + d; k = size code (0: byte,
+//                   1: halfword, 2: word) + 4 for writes; v = value
+class InstructionTrace
+{
+public:
+    enum Tag {
+        TAG_NEXT = 0x00,
+        TAG_JUMP = 0x01,
+        TAG_NEW16 = 0x02,
+        TAG_NEW32 = 0x03,
+        TAG_EXCEPTION = 0x04,
+        TAG_REGISTER = 0x10,
+        TAG_MEMORY = 0x20,
+        TAG_MEMORY_WRITE = 0x04     // Added to TAG_MEMORY with the size code
+    };
+
+    InstructionTrace();
+    ~InstructionTrace();
+
+    bool open(const std::string& path, bool compress);
+    void close();
+    bool is_open() const { return m_file.is_open(); }
+    uint64_t instructions() const { return m_instructions; }
+
+    // Called before the instruction executes, so its effects follow it
+    void instruction(uint32_t pc, uint32_t opcode, uint32_t length) {
+        uint32_t expected = m_next_pc;
+        m_next_pc = pc + length;
+        m_instructions++;
+        uint32_t& known = m_opcodes[pc];
+        // Opcode 0 reads as "not seen": an all-zero opcode is just resent
+        if (known == opcode && known != 0) {
+            if (pc == expected) {
+                put_byte(TAG_NEXT);
+            } else {
+                put_byte(TAG_JUMP);
+                put_varint(zigzag(pc - expected));
+            }
+        } else {
+            known = opcode;
+            put_byte(length == 4 ? TAG_NEW32 : TAG_NEW16);
+            put_varint(zigzag(pc - expected));
+            put_varint(opcode);
+        }
+        end_record();
+    }
+
+    void register_write(uint8_t reg, uint32_t value) {
+        put_byte(static_cast<uint8_t>(TAG_REGISTER | (reg & 0x0F)));
+        put_varint(value);
+        end_record();
+    }
+
+    void memory_access(uint32_t address, uint32_t value, uint32_t size, bool write) {
+        uint8_t size_code = size == 4 ? 2 : (size == 2 ? 1 : 0);
+        put_byte(static_cast<uint8_t>(TAG_MEMORY | (write ? TAG_MEMORY_WRITE : 0) | size_code));
+        put_varint(zigzag(address - m_last_address));
+        put_varint(value);
+        m_last_address = address;
+        end_record();
+    }
+
+    void exception_entry(uint32_t number) {
+        put_byte(TAG_EXCEPTION);
+        put_varint(number);
+        end_record();
+    }
+
+private:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    std::ofstream m_file;
+    bool m_compress;
+    std::vector<uint8_t> m_block;
+    std::vector<uint8_t> m_packed;
+    std::unordered_map<uint32_t, uint32_t> m_opcodes;   // PC -> opcode last written
+    uint32_t m_next_pc;
+    uint32_t m_last_address;
+    uint64_t m_instructions;
+
+    static uint32_t zigzag(uint32_t delta) {
+        int32_t d = static_cast<int32_t>(delta);
+        return (static_cast<uint32_t>(d) << 1) ^ static_cast<uint32_t>(d >> 31);
+    }
+    void put_byte(uint8_t value) { m_block.push_back(value); }
+    void put_varint(uint32_t value) {
+        while (value >= 0x80) {
+            m_block.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_block.push_back(static_cast<uint8_t>(value));
+    }
+    void end_record() {
+        if (m_block.size() >= BLOCK_SIZE) {
+            flush_block();
+        }
+    }
+    void flush_block();
+};
+
+#endif // INSTRUCTION_TRACE_H
@@ -11,6 +11,9 @@ Log& Log::getInstance()
 
 void Log::set_log_file(const std::string& filename)
 {
+    // The writer thread owns the file while it runs
+    bool restart = m_writer.joinable();
+    stop_writer();
     if (m_file_open) {
         m_log_file.close();
         m_file_open = false;
@@ -20,6 +23,39 @@ void Log::set_log_file(const std::string& filename)
     if (m_log_file.is_open()) {
         m_file_open = true;
     }
+    if (restart) {
+        start_writer();
+    }
+}
+
+void Log::enable_async(LogOverflowPolicy policy, size_t queue_size)
+{
+    stop_writer();
+    m_overflow = policy;
+    m_queue.reset(new SpscRing<Record>(queue_size));
+    m_async = true;
+    start_writer();
+}
+
+void Log::flush()
+{
+    if (m_writer.joinable()) {
+        uint64_t queued = m_queued.load(std::memory_order_acquire);
+        uint64_t written;
+        while ((written = m_written.load(std::memory_order_acquire)) < queued) {
+            wait_for_progress(written);
+        }
+    }
+    std::cout.flush();
+}
+
+// Sleep until the writer has written more than `written` records
+void Log::wait_for_progress(uint64_t written)
+{
+    std::unique_lock<std::mutex> lock(m_wait_lock);
+    m_progress.wait(lock, [this, written] {
+        return m_written.load(std::memory_order_acquire) != written;
+    });
 }
 
 void Log::error(const std::string& message)
@@ -51,58 +87,62 @@ void Log::log_instruction(uint32_t pc, uint16_t instruction,
                          const std::string& name, const std::string& details)
 {
     if (m_log_level >= LOG_TRACE) {
-        std::stringstream ss;
-        ss << "[INST] PC:0x" << std::hex << pc 
-           << " OPCODE:0x" << std::hex << instruction
-           << " " << name << " " << details;
-        write_to_outputs(ss.str());
+        Record record;
+        record.kind = Record::INSTRUCTION;
+        record.address = pc;
+        record.value = instruction;
+        record.text = name + " " + details;
+        submit(std::move(record));
     }
 }
 
 void Log::log_register_access(const std::string& reg_name, uint32_t value, bool write)
 {
     if (m_log_level >= LOG_TRACE) {
-        std::stringstream ss;
-        ss << "[REG] " << (write ? "WRITE" : "READ") 
-           << " " << reg_name << " = 0x" << std::hex << value;
-        write_to_outputs(ss.str());
+        Record record;
+        record.kind = Record::REGISTER;
+        record.write = write;
+        record.value = value;
+        record.text = reg_name;
+        submit(std::move(record));
     }
 }
 
 void Log::log_memory_access(uint32_t address, uint32_t value, uint32_t size, bool write)
 {
     if (m_log_level >= LOG_TRACE) {
-        std::stringstream ss;
-        ss << "[MEM] " << (write ? "WRITE" : "READ") 
-           << " [0x" << std::hex << address << "] = 0x" << std::hex << value 
-           << " (size: " << std::dec << size << ")";
-        write_to_outputs(ss.str());
+        Record record;
+        record.kind = Record::MEMORY;
+        record.write = write;
+        record.address = address;
+        record.value = value;
+        record.size = size;
+        submit(std::move(record));
     }
 }
 
 void Log::log(LogLevel level, const std::string& message)
 {
     if (level <= m_log_level) {
-        std::string full_message = get_timestamp() + " [" + level_to_string(level) + "] " + message;
-        write_to_outputs(full_message);
+        Record record;
+        record.level = level;
+        record.time = sc_time_stamp().value();
+        record.text = message;
+        submit(std::move(record));
     }
 }
 
 void Log::close()
 {
+    stop_writer();
+    m_async = false;
+    m_queue.reset();
     if (m_file_open) {
         m_log_file.close();
         m_file_open = false;
     }
 }
 
-std::string Log::get_timestamp() const
-{
-    std::stringstream ss;
-    ss << sc_time_stamp().to_string();
-    return ss.str();
-}
-
 std::string Log::level_to_string(LogLevel level) const
 {
     switch (level) {
@@ -115,15 +155,148 @@ std::string Log::level_to_string(LogLevel level) const
     }
 }
 
-void Log::write_to_outputs(const std::string& message)
+void Log::submit(Record&& record)
+{
+    if (!m_writer.joinable()) {
+        write_to_outputs(format_record(record));
+        return;
+    }
+
+    // Normally only the simulation thread logs; peripheral and debug
+    // threads take turns with it on this flag to keep the queue SPSC
+    while (m_producer_lock.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    // Sample the writer's count before each push: the batch that frees space
+    // for a failed push finishes after it, so it is always seen as progress
+    uint64_t written = m_written.load(std::memory_order_acquire);
+    bool queued = m_queue->push(std::move(record));
+    while (!queued && m_overflow == LOG_OVERFLOW_BLOCK) {
+        // Full, so the writer is busy: sleep until it finishes a batch
+        wait_for_progress(written);
+        written = m_written.load(std::memory_order_acquire);
+        queued = m_queue->push(std::move(record));
+    }
+    if (queued) {
+        m_queued.fetch_add(1, std::memory_order_release);
+    } else {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_producer_lock.clear(std::memory_order_release);
+
+    // Wake the writer only if it went idle; the fence pairs with the one in
+    // writer_thread so either it sees the record or we see it idle
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_writer_idle.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_wait_lock);
+        m_wake.notify_one();
+    }
+}
+
+std::string Log::format_record(const Record& record) const
+{
+    std::stringstream ss;
+    switch (record.kind) {
+        case Record::INSTRUCTION:
+            ss << "[INST] PC:0x" << std::hex << record.address 
+               << " OPCODE:0x" << std::hex << record.value
+               << " " << record.text;
+            break;
+        case Record::REGISTER:
+            ss << "[REG] " << (record.write ? "WRITE" : "READ") 
+               << " " << record.text << " = 0x" << std::hex << record.value;
+            break;
+        case Record::MEMORY:
+            ss << "[MEM] " << (record.write ? "WRITE" : "READ") 
+               << " [0x" << std::hex << record.address << "] = 0x" << std::hex << record.value 
+               << " (size: " << std::dec << record.size << ")";
+            break;
+        default:
+            ss << sc_time::from_value(record.time).to_string()
+               << " [" << level_to_string(record.level) << "] " << record.text;
+            break;
+    }
+    return ss.str();
+}
+
+void Log::write_to_outputs(const std::string& message, bool flush)
 {
     if (m_console_output) {
-        std::cout << message << std::endl;
+        std::cout << message << '\n';
+        if (flush) {
+            std::cout.flush();
+        }
     }
     
     if (m_file_open && m_log_file.is_open()) {
-        m_log_file << message << std::endl;
-        m_log_file.flush();
+        m_log_file << message << '\n';
+        if (flush) {
+            m_log_file.flush();
+        }
+    }
+}
+
+void Log::start_writer()
+{
+    if (m_async && !m_writer.joinable()) {
+        m_stop_writer = false;
+        m_writer = std::thread(&Log::writer_thread, this);
+    }
+}
+
+void Log::stop_writer()
+{
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_wait_lock);
+            m_stop_writer = true;
+            m_wake.notify_one();
+        }
+        m_writer.join();
+    }
+}
+
+void Log::writer_thread()
+{
+    uint64_t reported_drops = 0;
+    Record record;
+    while (true) {
+        // Sample the stop flag first so the final pass sees every record
+        bool stopping = m_stop_writer.load(std::memory_order_acquire);
+        uint64_t count = 0;
+        while (m_queue->pop(record)) {
+            write_to_outputs(format_record(record), false);
+            count++;
+        }
+        uint64_t drops = m_dropped.load(std::memory_order_relaxed);
+        if (drops != reported_drops) {
+            write_to_outputs("[LOG] " + std::to_string(drops - reported_drops) +
+                             " messages dropped (log queue full)", false);
+            reported_drops = drops;
+        }
+        if (count != 0) {
+            // One flush per batch; flush() returns once the batch is out
+            std::cout.flush();
+            if (m_file_open) {
+                m_log_file.flush();
+            }
+            m_written.fetch_add(count, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(m_wait_lock);
+            m_progress.notify_all();
+        }
+        if (stopping) {
+            break;
+        }
+        if (count == 0) {
+            // Nothing queued: sleep until a producer or stop_writer() wakes us
+            std::unique_lock<std::mutex> lock(m_wait_lock);
+            m_writer_idle.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_wake.wait(lock, [this] {
+                return !m_queue->empty() || m_stop_writer.load(std::memory_order_acquire);
+            });
+            m_writer_idle.store(false, std::memory_order_relaxed);
+        }
     }
 }
 
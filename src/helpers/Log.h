@@ -2,12 +2,24 @@
 #define LOG_H
 
 #include <systemc>
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <thread>
+#include "SpscRing.h"
 
 using namespace sc_core;
 
+// Most verbose level compiled into the binary. Log sites above it are removed
+// entirely, e.g. -DARM_TLM_MIN_LOG_LEVEL=2 drops all DEBUG and TRACE sites.
+#ifndef ARM_TLM_MIN_LOG_LEVEL
+#define ARM_TLM_MIN_LOG_LEVEL 4
+#endif
+
 enum LogLevel {
     LOG_ERROR = 0,
     LOG_WARNING = 1,
@@ -16,6 +28,12 @@ enum LogLevel {
     LOG_TRACE = 4
 };
 
+// What an asynchronous log does when its queue is full
+enum LogOverflowPolicy {
+    LOG_OVERFLOW_BLOCK = 0,     // Wait for the writer thread (nothing is lost)
+    LOG_OVERFLOW_DROP = 1       // Discard the message and count it
+};
+
 class Log
 {
 public:
@@ -25,8 +43,15 @@ public:
     // Configuration
     void set_log_level(LogLevel level) { m_log_level = level; }
     LogLevel get_log_level() const { return m_log_level; }
+    bool is_enabled(LogLevel level) const { return level <= m_log_level; }
     void set_log_file(const std::string& filename);
     void enable_console_output(bool enable) { m_console_output = enable; }
+    // Hand messages to a writer thread through a bounded queue instead of
+    // writing them on the caller's thread. Records are formatted and written
+    // by the writer; flush() waits until everything queued so far is out.
+    void enable_async(LogOverflowPolicy policy, size_t queue_size = 65536);
+    void flush();
+    uint64_t dropped_messages() const { return m_dropped; }
     
     // Logging methods
     void error(const std::string& message);
@@ -48,14 +73,29 @@ public:
     // Generic logging with level
     void log(LogLevel level, const std::string& message);
     
-    // Close log file
+    // Stop the writer thread (after draining it) and close the log file
     void close();
 
     std::string hex32(uint32_t v);
 
 private:
+    // One message, captured on the logging thread and formatted on output
+    struct Record {
+        enum Kind : uint8_t { MESSAGE, INSTRUCTION, REGISTER, MEMORY };
+        Kind kind = MESSAGE;
+        LogLevel level = LOG_INFO;
+        bool write = false;
+        uint32_t address = 0;       // PC for INSTRUCTION
+        uint32_t value = 0;         // Opcode for INSTRUCTION
+        uint32_t size = 0;
+        uint64_t time = 0;          // sc_time value for MESSAGE
+        std::string text;           // Message, register name or "name details"
+    };
+
     // Singleton pattern
-    Log() : m_log_level(LOG_INFO), m_console_output(true), m_file_open(false) {}
+    Log() : m_log_level(LOG_INFO), m_console_output(true), m_file_open(false),
+            m_async(false), m_overflow(LOG_OVERFLOW_BLOCK), m_stop_writer(false),
+            m_writer_idle(false), m_queued(0), m_written(0), m_dropped(0) {}
     ~Log() { close(); }
     
     Log(const Log&) = delete;
@@ -65,18 +105,52 @@ private:
     std::ofstream m_log_file;
     bool m_console_output;
     bool m_file_open;
+
+    // Asynchronous output
+    bool m_async;
+    LogOverflowPolicy m_overflow;
+    std::unique_ptr<SpscRing<Record>> m_queue;
+    std::atomic_flag m_producer_lock = ATOMIC_FLAG_INIT;   // Serializes the (rare) other producer threads
+    std::thread m_writer;
+    std::atomic<bool> m_stop_writer;
+    std::atomic<bool> m_writer_idle;            // Writer is (about to be) waiting on m_wake
+    std::mutex m_wait_lock;                     // Guards the waits below, never the queue
+    std::condition_variable m_wake;             // Queue no longer empty, or stop requested
+    std::condition_variable m_progress;         // Writer finished a batch (flush, full queue)
+    std::atomic<uint64_t> m_queued;
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
     
     // Helper methods
-    std::string get_timestamp() const;
     std::string level_to_string(LogLevel level) const;
-    void write_to_outputs(const std::string& message);
+    // Queue a record for the writer thread. The ring is single-producer, but
+    // peripheral and debug threads log too, so producers take turns on a spin
+    // flag. That costs one uncontended test-and-set per record on the
+    // simulation thread; a multi-producer queue would cost more on every push
+    // for what is, outside of the simulation thread, a rare event.
+    void submit(Record&& record);
+    std::string format_record(const Record& record) const;
+    void write_to_outputs(const std::string& message, bool flush = true);
+    void start_writer();
+    void stop_writer();
+    void writer_thread();
+    void wait_for_progress(uint64_t written);
 };
 
-// Convenience macros
-#define LOG_ERROR(msg) Log::getInstance().error(msg)
-#define LOG_WARNING(msg) Log::getInstance().warning(msg)
-#define LOG_INFO(msg) Log::getInstance().info(msg)
-#define LOG_DEBUG(msg) Log::getInstance().debug(msg)
-#define LOG_TRACE(msg) Log::getInstance().trace(msg)
+// True if messages at this level are both compiled in and enabled at run time.
+// Use it to guard formatting work that is not a plain LOG_* argument.
+#define LOG_ENABLED(level) \
+    ((level) <= ARM_TLM_MIN_LOG_LEVEL && Log::getInstance().is_enabled(level))
+
+// Convenience macros. The message expression is only evaluated when the
+// level is enabled, so string building costs nothing on quiet runs.
+#define LOG_AT_LEVEL(level, method, msg) \
+    do { if (LOG_ENABLED(level)) Log::getInstance().method(msg); } while (0)
+
+#define LOG_ERROR(msg) LOG_AT_LEVEL(LOG_ERROR, error, msg)
+#define LOG_WARNING(msg) LOG_AT_LEVEL(LOG_WARNING, warning, msg)
+#define LOG_INFO(msg) LOG_AT_LEVEL(LOG_INFO, info, msg)
+#define LOG_DEBUG(msg) LOG_AT_LEVEL(LOG_DEBUG, debug, msg)
+#define LOG_TRACE(msg) LOG_AT_LEVEL(LOG_TRACE, trace, msg)
 
 #endif // LOG_H
\ No newline at end of file
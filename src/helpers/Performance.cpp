@@ -43,8 +43,11 @@ void Performance::print_performance_report() const
     std::cout << "Instructions executed: " << m_instructions_executed << std::endl;
     std::cout << "Memory reads: " << m_memory_reads << std::endl;
     std::cout << "Memory writes: " << m_memory_writes << std::endl;
-    std::cout << "Register reads: " << m_register_reads << std::endl;
-    std::cout << "Register writes: " << m_register_writes << std::endl;
+    if (m_register_reads || m_register_writes) {
+        // Only counted with --register-stats (or TRACE logging)
+        std::cout << "Register reads: " << m_register_reads << std::endl;
+        std::cout << "Register writes: " << m_register_writes << std::endl;
+    }
     std::cout << "Branches taken: " << m_branches_taken << std::endl;
     std::cout << "IRQ count: " << m_irq_count << std::endl;
     
@@ -0,0 +1,143 @@
+#include "Profiler.h"
+#include "SymbolTable.h"
+#include "Log.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+Profiler::Profiler(const SymbolTable* symbols) :
+    m_symbols(symbols),
+    m_current(0),
+    m_overflow(0),
+    m_total_instructions(0),
+    m_total_cycles(0)
+{
+}
+
+void Profiler::enter(uint32_t function)
+{
+    Node& caller = m_nodes[m_current];
+    m_call_edges[std::make_pair(caller.function, function)]++;
+    if (caller.depth >= MAX_DEPTH) {
+        m_overflow++;
+        return;
+    }
+
+    auto it = caller.children.find(function);
+    if (it != caller.children.end()) {
+        m_current = it->second;
+        return;
+    }
+    uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    uint32_t depth = caller.depth + 1;
+    caller.children[function] = index;  // Before push_back: it may move caller
+    m_nodes.push_back(Node{ function, m_current, depth, 0, 0, {} });
+    m_current = index;
+}
+
+std::string Profiler::name(uint32_t address) const
+{
+    if (m_symbols) {
+        return m_symbols->describe(address);
+    }
+    std::stringstream ss;
+    ss << "0x" << std::hex << std::setfill('0') << std::setw(8) << address;
+    return ss.str();
+}
+
+bool Profiler::write_reports(const std::string& prefix) const
+{
+    std::ofstream flat(prefix + ".txt");
+    std::ofstream folded(prefix + ".folded");
+    if (!flat || !folded) {
+        LOG_ERROR("Cannot write profile: " + prefix);
+        return false;
+    }
+
+    auto percent = [this](uint64_t cycles) {
+        return m_total_cycles ? 100.0 * static_cast<double>(cycles) / static_cast<double>(m_total_cycles) : 0.0;
+    };
+
+    // Flat profile: self cost per function (frame entry address)
+    struct FunctionStats {
+        uint64_t instructions = 0;
+        uint64_t cycles = 0;
+        uint64_t calls = 0;
+    };
+    std::map<uint32_t, FunctionStats> functions;
+    for (const auto& node : m_nodes) {
+        functions[node.function].instructions += node.instructions;
+        functions[node.function].cycles += node.cycles;
+    }
+    for (const auto& edge : m_call_edges) {
+        functions[edge.first.second].calls += edge.second;
+    }
+    std::vector<std::pair<uint32_t, FunctionStats>> by_cycles(functions.begin(), functions.end());
+    std::sort(by_cycles.begin(), by_cycles.end(), [](const auto& a, const auto& b) {
+        return a.second.cycles > b.second.cycles;
+    });
+
+    flat << "Flat profile: " << m_total_instructions << " instructions, " << m_total_cycles << " cycles\n\n";
+    flat << "  %cycles        cycles  instructions       calls  function\n";
+    flat << std::fixed << std::setprecision(2);
+    for (const auto& entry : by_cycles) {
+        flat << std::setw(8) << percent(entry.second.cycles) << "%"
+             << std::setw(14) << entry.second.cycles
+             << std::setw(14) << entry.second.instructions
+             << std::setw(12) << entry.second.calls
+             << "  " << name(entry.first) << "\n";
+    }
+
+    // Hottest instructions
+    const size_t HOT_PCS = 50;
+    std::vector<std::pair<uint32_t, PcStats>> pcs(m_pcs.begin(), m_pcs.end());
+    std::sort(pcs.begin(), pcs.end(), [](const auto& a, const auto& b) {
+        return a.second.cycles > b.second.cycles || (a.second.cycles == b.second.cycles && a.first < b.first);
+    });
+    if (pcs.size() > HOT_PCS) {
+        pcs.resize(HOT_PCS);
+    }
+    flat << "\nHot instructions\n\n";
+    flat << "  %cycles        cycles  instructions  address\n";
+    for (const auto& entry : pcs) {
+        std::stringstream address;
+        address << "0x" << std::hex << std::setfill('0') << std::setw(8) << entry.first;
+        flat << std::setw(8) << percent(entry.second.cycles) << "%"
+             << std::setw(14) << entry.second.cycles
+             << std::setw(14) << entry.second.instructions
+             << "  " << address.str();
+        if (m_symbols) {
+            flat << "  " << m_symbols->describe(entry.first);
+        }
+        flat << "\n";
+    }
+
+    flat << "\nCall graph edges\n\n";
+    flat << "       calls  caller -> callee\n";
+    for (const auto& edge : m_call_edges) {
+        flat << std::setw(12) << edge.second << "  " << name(edge.first.first)
+             << " -> " << name(edge.first.second) << "\n";
+    }
+
+    // Folded stacks for flamegraph.pl / speedscope
+    for (uint32_t i = 0; i < m_nodes.size(); i++) {
+        if (m_nodes[i].cycles == 0) {
+            continue;
+        }
+        std::vector<uint32_t> path;
+        for (uint32_t n = i; ; n = m_nodes[n].parent) {
+            path.push_back(m_nodes[n].function);
+            if (n == 0) {
+                break;
+            }
+        }
+        for (size_t j = path.size(); j-- > 0; ) {
+            folded << name(path[j]) << (j ? ";" : "");
+        }
+        folded << " " << m_nodes[i].cycles << "\n";
+    }
+
+    LOG_INFO("Profile written to " + prefix + ".txt and " + prefix + ".folded");
+    return true;
+}
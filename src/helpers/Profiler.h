@@ -0,0 +1,92 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class SymbolTable;
+
+// Opt-in guest profiler. The CPU reports every executed instruction with the
+// cycles it took and whether it was a taken call or return. From that the
+// profiler keeps per-PC counts, call edges, and a shadow call stack (as a tree
+// of frames) for folded-stack output.
+class Profiler
+{
+public:
+    enum Transfer {
+        TRANSFER_NONE = 0,
+        TRANSFER_CALL,    // BL / BLX: next_pc is the callee
+        TRANSFER_RETURN   // BX LR, POP {..., pc}, LDM/LDR with PC from the stack
+    };
+
+    explicit Profiler(const SymbolTable* symbols = nullptr);
+
+    void record(uint32_t pc, uint64_t cycles, Transfer transfer, uint32_t next_pc) {
+        PcStats& stats = m_pcs[pc];
+        stats.instructions++;
+        stats.cycles += cycles;
+        if (m_nodes.empty()) {
+            m_nodes.push_back(Node{ pc, 0, 0, 0, 0, {} });  // Root frame: first function run
+        }
+        Node& node = m_nodes[m_current];
+        node.instructions++;
+        node.cycles += cycles;
+        m_total_instructions++;
+        m_total_cycles += cycles;
+        if (transfer == TRANSFER_CALL) {
+            enter(next_pc & ~1u);
+        } else if (transfer == TRANSFER_RETURN) {
+            leave();
+        }
+    }
+
+    // Exception entry behaves like a call to the handler; the exception
+    // return instruction pops it like any other return
+    void exception_entry(uint32_t handler) { if (!m_nodes.empty()) enter(handler & ~1u); }
+
+    // Writes <prefix>.txt (flat profile, hot instructions, call edges) and
+    // <prefix>.folded (one "caller;callee;... cycles" line per stack)
+    bool write_reports(const std::string& prefix) const;
+
+private:
+    static const uint32_t MAX_DEPTH = 256;  // Runaway recursion stays in the deepest frame
+
+    struct PcStats {
+        uint64_t instructions = 0;
+        uint64_t cycles = 0;
+    };
+
+    struct Node {
+        uint32_t function;  // Entry address of the frame
+        uint32_t parent;
+        uint32_t depth;
+        uint64_t instructions;  // Self counts
+        uint64_t cycles;
+        std::unordered_map<uint32_t, uint32_t> children;  // Callee entry -> node
+    };
+
+    void enter(uint32_t function);
+    void leave() {
+        if (m_overflow != 0) {
+            m_overflow--;  // Return from a call that enter() did not push
+        } else if (m_current != 0) {
+            m_current = m_nodes[m_current].parent;
+        }
+    }
+    std::string name(uint32_t address) const;
+
+    const SymbolTable* m_symbols;
+    std::unordered_map<uint32_t, PcStats> m_pcs;
+    std::vector<Node> m_nodes;
+    uint32_t m_current;
+    uint32_t m_overflow;  // Calls past MAX_DEPTH still waiting for their return
+    std::map<std::pair<uint32_t, uint32_t>, uint64_t> m_call_edges;  // (caller, callee) -> calls
+    uint64_t m_total_instructions;
+    uint64_t m_total_cycles;
+};
+
+#endif // PROFILER_H
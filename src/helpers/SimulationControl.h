@@ -0,0 +1,30 @@
+#ifndef SIMULATION_CONTROL_H
+#define SIMULATION_CONTROL_H
+
+#include <string>
+
+// Program-requested end of simulation (semihosting SYS_EXIT, Trace exit
+// register, instruction limit). Requests are recorded here; the CPU stops
+// the kernel at the next instruction boundary and sc_main returns the code.
+class SimulationControl
+{
+public:
+    static void request_exit(int code, const std::string& reason) {
+        if (!s_exit_requested) {
+            s_exit_requested = true;
+            s_exit_code = code;
+            s_exit_reason = reason;
+        }
+    }
+
+    static bool exit_requested() { return s_exit_requested; }
+    static int exit_code() { return s_exit_code; }
+    static const std::string& exit_reason() { return s_exit_reason; }
+
+private:
+    static inline bool s_exit_requested = false;
+    static inline int s_exit_code = 0;
+    static inline std::string s_exit_reason;
+};
+
+#endif // SIMULATION_CONTROL_H
@@ -0,0 +1,68 @@
+#include "SymbolTable.h"
+#include <algorithm>
+#include <sstream>
+
+void SymbolTable::add(const std::string& name, uint32_t address, uint32_t size, bool is_function)
+{
+    m_symbols.push_back({ name, address, size, is_function });
+    m_sorted = false;
+}
+
+void SymbolTable::finalize()
+{
+    // Functions first among symbols sharing an address so they win lookups
+    std::stable_sort(m_symbols.begin(), m_symbols.end(), [](const Symbol& a, const Symbol& b) {
+        if (a.address != b.address) return a.address < b.address;
+        return a.is_function && !b.is_function;
+    });
+    m_sorted = true;
+}
+
+const SymbolTable::Symbol* SymbolTable::lookup(uint32_t address) const
+{
+    if (!m_sorted || m_symbols.empty()) {
+        return nullptr;
+    }
+
+    auto it = std::upper_bound(m_symbols.begin(), m_symbols.end(), address,
+                               [](uint32_t addr, const Symbol& s) { return addr < s.address; });
+    if (it == m_symbols.begin()) {
+        return nullptr;
+    }
+
+    // Walk back over symbols at the same address to the preferred (first) one
+    uint32_t start = (it - 1)->address;
+    while (it != m_symbols.begin() && (it - 1)->address == start) {
+        --it;
+    }
+    const Symbol& sym = *it;
+    if (sym.size != 0 && address >= sym.address + sym.size) {
+        return nullptr;  // Past the end of a sized symbol: in a gap
+    }
+    return &sym;
+}
+
+const SymbolTable::Symbol* SymbolTable::find(const std::string& name) const
+{
+    for (const auto& sym : m_symbols) {
+        if (sym.name == name) {
+            return &sym;
+        }
+    }
+    return nullptr;
+}
+
+std::string SymbolTable::describe(uint32_t address) const
+{
+    std::stringstream ss;
+    const Symbol* sym = lookup(address);
+    if (sym) {
+        ss << sym->name;
+        if (address != sym->address) {
+            ss << "+0x" << std::hex << (address - sym->address);
+        }
+    } else {
+        ss << "0x" << std::hex << address;
+    }
+    return ss.str();
+}
@@ -0,0 +1,42 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Address-sorted symbol table captured from an ELF image
+class SymbolTable
+{
+public:
+    struct Symbol {
+        std::string name;
+        uint32_t address;   // Thumb bit cleared
+        uint32_t size;
+        bool is_function;
+    };
+
+    void add(const std::string& name, uint32_t address, uint32_t size, bool is_function);
+    void clear() { m_symbols.clear(); m_sorted = true; }
+
+    // Sort after loading; lookups require a finalized table
+    void finalize();
+
+    // Symbol covering address (sized symbols) or the closest one below it; nullptr if none
+    const Symbol* lookup(uint32_t address) const;
+    // Exact name lookup
+    const Symbol* find(const std::string& name) const;
+
+    // "name+0xoff" or "0xaddress" when no symbol is known
+    std::string describe(uint32_t address) const;
+
+    bool empty() const { return m_symbols.empty(); }
+    size_t size() const { return m_symbols.size(); }
+    const std::vector<Symbol>& symbols() const { return m_symbols; }
+
+private:
+    std::vector<Symbol> m_symbols;
+    bool m_sorted { true };
+};
+
+#endif // SYMBOL_TABLE_H
@@ -1,88 +1,467 @@
 #include <systemc>
 #include "Simulator.h"
 #include "Log.h"
+#include "SimulationControl.h"
+#include "BatchRunner.h"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace sc_core;
 
-int sc_main(int argc, char* argv[])
+// Core used when --core is not given (CMake ARM_CORE_TYPE)
+#ifndef ARM_TLM_DEFAULT_CORE
+#define ARM_TLM_DEFAULT_CORE "CORTEX_M0_PLUS"
+#endif
+
+// Parse a time value such as "10us", "500ns" or "2ms" (bare numbers are ns)
+static bool parse_time(const std::string& text, sc_time& result)
 {
-    std::cout << "ARM Cortex-M0 SystemC-TLM Simulator" << std::endl;
-    std::cout << "====================================" << std::endl;
-    
-    // Parse command line arguments
+    // A time starts with a digit: no sign (negative times are meaningless),
+    // no leading blanks, and no "inf" or "nan"
+    if (text.empty() || !(std::isdigit(static_cast<unsigned char>(text[0])) || text[0] == '.')) {
+        return false;
+    }
+    size_t pos = 0;
+    double value;
+    try {
+        value = std::stod(text, &pos);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    std::string unit = text.substr(pos);
+    if (unit == "ps") {
+        result = sc_time(value, SC_PS);
+    } else if (unit.empty() || unit == "ns") {
+        result = sc_time(value, SC_NS);
+    } else if (unit == "us") {
+        result = sc_time(value, SC_US);
+    } else if (unit == "ms") {
+        result = sc_time(value, SC_MS);
+    } else if (unit == "s") {
+        result = sc_time(value, SC_SEC);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Parse a frequency such as "48MHz", "1GHz" or "32768Hz" (bare numbers are Hz)
+static bool parse_frequency(const std::string& text, double& result)
+{
+    size_t pos = 0;
+    double value;
+    try {
+        value = std::stod(text, &pos);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    std::string unit = text.substr(pos);
+    if (unit.empty() || unit == "Hz") {
+        result = value;
+    } else if (unit == "kHz") {
+        result = value * 1e3;
+    } else if (unit == "MHz") {
+        result = value * 1e6;
+    } else if (unit == "GHz") {
+        result = value * 1e9;
+    } else {
+        return false;
+    }
+    return result > 0;
+}
+
+// Parse a non-negative decimal integer; the whole text must be the number
+static bool parse_count(const std::string& text, uint64_t& result)
+{
+    if (text.empty() || text[0] == '-' || text[0] == '+') {
+        return false;
+    }
+    size_t pos = 0;
+    try {
+        result = std::stoull(text, &pos);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return pos == text.size();
+}
+
+// Everything needed to set up and run one simulation
+struct RunOptions {
     std::string hex_file;
+    ImageFormat image_format = IMAGE_AUTO;  // --hex still accepts ELF and .bin images
     std::string log_file = "simulation.log";
     LogLevel log_level = LOG_INFO;
+    bool log_async = false;
+    LogOverflowPolicy log_overflow = LOG_OVERFLOW_BLOCK;
     bool gdb_enabled = false;
     int gdb_port = 3333;
+    ExecutionEngine engine = ENGINE_INTERPRETER;
+    std::string core = ARM_TLM_DEFAULT_CORE;
+    sc_time quantum = SC_ZERO_TIME;
+    std::vector<MemoryRegion> memory_regions;
+    std::string save_checkpoint;
+    std::string restore_checkpoint;
+    sc_time checkpoint_at = SC_ZERO_TIME;
+    sc_time max_time = sc_time(10, SC_SEC);
+    bool max_time_given = false;
+    uint64_t max_instructions = 0;
+    std::string profile_prefix;
+    std::string inst_trace;
+    bool inst_trace_compress = false;
+    double core_clock = 1e9;
+    uint32_t flash_wait_states = 0;
+    bool register_stats = false;
+    std::string trace_out = "stdout";
+    std::string uart_input = "none";
+};
+
+// Elaborate and run one simulation; returns the process exit code
+static int run_simulation(const RunOptions& opt)
+{
+    int exit_code = 0;
+    try {
+        // Create simulator
+        Simulator sim("simulator", opt.hex_file, opt.memory_regions, opt.core, opt.image_format);
+        
+        // Configure logging
+        sim.set_log_level(opt.log_level);
+        sim.set_log_file(opt.log_file);
+        if (opt.log_async) {
+            sim.enable_async_log(opt.log_overflow);
+        }
+        sim.enable_performance_monitoring(true);
+        sim.enable_register_stats(opt.register_stats);
+        sim.set_engine(opt.engine);
+        if (!sim.set_trace_output(opt.trace_out)) {
+            return 1;
+        }
+        if (!sim.set_uart_input(opt.uart_input)) {
+            return 1;
+        }
+        sim.set_quantum(opt.quantum);
+        sim.set_core_clock(opt.core_clock);
+        sim.set_flash_wait_states(opt.flash_wait_states);
+        
+        if (!opt.restore_checkpoint.empty() && !sim.restore_checkpoint(opt.restore_checkpoint)) {
+            std::cerr << "Failed to restore checkpoint: " << opt.restore_checkpoint << std::endl;
+            return 1;
+        }
+
+        if (!opt.profile_prefix.empty()) {
+            sim.enable_profiling(opt.profile_prefix);
+        }
+        if (!opt.inst_trace.empty() && !sim.enable_instruction_trace(opt.inst_trace, opt.inst_trace_compress)) {
+            std::cerr << "Cannot create instruction trace: " << opt.inst_trace << std::endl;
+            return 1;
+        }
+
+        // Configure GDB server if requested
+        if (opt.gdb_enabled) {
+            sim.enable_gdb_server(opt.gdb_port);
+            std::cout << "GDB server enabled on port " << opt.gdb_port << std::endl;
+        }
+        
+        // Run simulation
+        std::cout << "Starting simulation..." << std::endl;
+        if (!opt.hex_file.empty()) {
+            std::cout << "Loading program: " << opt.hex_file << std::endl;
+        }
+        
+        if (opt.gdb_enabled) {
+            std::cout << "Waiting for GDB connection..." << std::endl;
+            std::cout << "Connect with: arm-none-eabi-gdb -ex 'target remote localhost:" << opt.gdb_port << "'" << std::endl;
+            // Run indefinitely when GDB is enabled to allow debugging
+            sim.run_simulation(SC_ZERO_TIME);  // Run indefinitely 
+        } else {
+            // Runs until the program exits (semihosting SYS_EXIT, Trace exit
+            // register) or a limit is reached. The CPU ends the run on an
+            // instruction boundary for exits, instruction limits and checkpoints.
+            sc_time run_time = opt.max_time;
+            if (opt.checkpoint_at != SC_ZERO_TIME) {
+                sim.set_stop_time(opt.checkpoint_at);
+                // The CPU stops at the checkpoint; only an explicit --max-time caps the run
+                if (!opt.max_time_given) {
+                    run_time = SC_ZERO_TIME;
+                }
+            }
+            sim.set_max_instructions(opt.max_instructions);
+            sim.run_simulation(run_time);
+        }
+
+        if (!opt.save_checkpoint.empty() && !sim.save_checkpoint(opt.save_checkpoint)) {
+            std::cerr << "Failed to save checkpoint: " << opt.save_checkpoint << std::endl;
+            return 1;
+        }
+        
+        std::cout << "Simulation completed." << std::endl;
+
+        if (SimulationControl::exit_requested()) {
+            exit_code = SimulationControl::exit_code();
+            std::cout << "Program exited with code " << exit_code
+                      << " (" << SimulationControl::exit_reason() << ")" << std::endl;
+        } else if (opt.max_time_given && opt.max_time != SC_ZERO_TIME && sc_time_stamp() >= opt.max_time) {
+            exit_code = 124;
+            std::cout << "Time limit reached" << std::endl;
+        }
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return exit_code;
+}
+
+int sc_main(int argc, char* argv[])
+{
+    // Parse command line arguments
+    RunOptions opt;
+    std::string batch_list;
+    std::string batch_results = "batch_results.jsonl";
+    std::string batch_logs;
+    unsigned batch_jobs = std::max(1u, std::thread::hardware_concurrency());
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
-        if (arg == "--hex" && i + 1 < argc) {
-            hex_file = argv[++i];
+        if ((arg == "--hex" || arg == "--elf" || arg == "--bin") && i + 1 < argc) {
+            opt.image_format = arg == "--elf" ? IMAGE_ELF : arg == "--bin" ? IMAGE_BIN : IMAGE_AUTO;
+            opt.hex_file = argv[++i];
         } else if (arg == "--log" && i + 1 < argc) {
-            log_file = argv[++i];
+            opt.log_file = argv[++i];
         } else if (arg == "--debug") {
-            log_level = LOG_DEBUG;
+            opt.log_level = LOG_DEBUG;
         } else if (arg == "--trace") {
-            log_level = LOG_TRACE;
+            opt.log_level = LOG_TRACE;
+        } else if (arg == "--log-async" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (policy == "block") {
+                opt.log_overflow = LOG_OVERFLOW_BLOCK;
+            } else if (policy == "drop") {
+                opt.log_overflow = LOG_OVERFLOW_DROP;
+            } else {
+                std::cerr << "Unknown log overflow policy: " << policy << " (expected block or drop)" << std::endl;
+                return 1;
+            }
+            opt.log_async = true;
         } else if (arg == "--gdb-port" && i + 1 < argc) {
-            gdb_enabled = true;
-            gdb_port = std::stoi(argv[++i]);
+            uint64_t port;
+            if (!parse_count(argv[++i], port) || port == 0 || port > 65535) {
+                std::cerr << "Invalid GDB port: " << argv[i] << std::endl;
+                return 1;
+            }
+            opt.gdb_enabled = true;
+            opt.gdb_port = static_cast<int>(port);
         } else if (arg == "--gdb") {
-            gdb_enabled = true;
+            opt.gdb_enabled = true;
+        } else if (arg.rfind("--engine", 0) == 0) {
+            std::string name;
+            if (arg.rfind("--engine=", 0) == 0) {
+                name = arg.substr(9);
+            } else if (arg == "--engine" && i + 1 < argc) {
+                name = argv[++i];
+            }
+            if (name == "block") {
+                opt.engine = ENGINE_BLOCK;
+            } else if (name == "interp") {
+                opt.engine = ENGINE_INTERPRETER;
+            } else {
+                std::cerr << "Unknown engine: " << name << " (expected interp or block)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--core" && i + 1 < argc) {
+            opt.core = argv[++i];
+        } else if (arg == "--quantum" && i + 1 < argc) {
+            if (!parse_time(argv[++i], opt.quantum)) {
+                std::cerr << "Invalid quantum: " << argv[i] << " (e.g. 10us, 500ns)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--region" && i + 1 < argc) {
+            MemoryRegion region;
+            if (!MemoryRegion::parse(argv[++i], region)) {
+                std::cerr << "Invalid region: " << argv[i] << " (expected name:base:size:attrs, e.g. flash:0x0:2M:rx)" << std::endl;
+                return 1;
+            }
+            opt.memory_regions.push_back(region);
+        } else if (arg == "--save-checkpoint" && i + 1 < argc) {
+            opt.save_checkpoint = argv[++i];
+        } else if (arg == "--restore-checkpoint" && i + 1 < argc) {
+            opt.restore_checkpoint = argv[++i];
+        } else if (arg == "--checkpoint-at" && i + 1 < argc) {
+            if (!parse_time(argv[++i], opt.checkpoint_at)) {
+                std::cerr << "Invalid checkpoint time: " << argv[i] << " (e.g. 20ms)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--max-time" && i + 1 < argc) {
+            if (!parse_time(argv[++i], opt.max_time)) {
+                std::cerr << "Invalid time limit: " << argv[i] << " (e.g. 50ms, 0 for none)" << std::endl;
+                return 1;
+            }
+            opt.max_time_given = true;
+        } else if (arg == "--max-instructions" && i + 1 < argc) {
+            if (!parse_count(argv[++i], opt.max_instructions)) {
+                std::cerr << "Invalid instruction limit: " << argv[i] << " (e.g. 1000000, 0 for none)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--clock" && i + 1 < argc) {
+            if (!parse_frequency(argv[++i], opt.core_clock)) {
+                std::cerr << "Invalid clock frequency: " << argv[i] << " (e.g. 48MHz)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--flash-wait-states" && i + 1 < argc) {
+            uint64_t wait_states;
+            if (!parse_count(argv[++i], wait_states) || wait_states > 255) {
+                std::cerr << "Invalid flash wait states: " << argv[i] << std::endl;
+                return 1;
+            }
+            opt.flash_wait_states = static_cast<uint32_t>(wait_states);
+        } else if (arg == "--register-stats") {
+            opt.register_stats = true;
+        } else if (arg == "--trace-out" && i + 1 < argc) {
+            opt.trace_out = argv[++i];
+        } else if (arg == "--uart-input" && i + 1 < argc) {
+            opt.uart_input = argv[++i];
+        } else if (arg == "--profile" && i + 1 < argc) {
+            opt.profile_prefix = argv[++i];
+        } else if (arg == "--inst-trace" && i + 1 < argc) {
+            opt.inst_trace = argv[++i];
+        } else if (arg == "--inst-trace-compress") {
+            opt.inst_trace_compress = true;
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch_list = argv[++i];
+        } else if ((arg == "-j" && i + 1 < argc) || (arg.rfind("-j", 0) == 0 && arg.size() > 2)) {
+            std::string text = arg == "-j" ? argv[++i] : arg.substr(2);
+            uint64_t jobs;
+            if (!parse_count(text, jobs) || jobs == 0 || jobs > 4096) {
+                std::cerr << "Invalid number of batch workers: " << text << std::endl;
+                return 1;
+            }
+            batch_jobs = static_cast<unsigned>(jobs);
+        } else if (arg == "--batch-results" && i + 1 < argc) {
+            batch_results = argv[++i];
+        } else if (arg == "--batch-logs" && i + 1 < argc) {
+            batch_logs = argv[++i];
         } else if (arg == "--help" || arg == "-h") {
             std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
             std::cout << "Options:" << std::endl;
             std::cout << "  --hex <file>        Load Intel HEX file" << std::endl;
+            std::cout << "  --elf <file>        Load ELF file (segments, entry point, symbols)" << std::endl;
+            std::cout << "  --bin <file>        Map raw binary image at address 0 (copy-on-write)" << std::endl;
             std::cout << "  --log <file>        Log file (default: simulation.log)" << std::endl;
             std::cout << "  --debug             Enable debug logging" << std::endl;
             std::cout << "  --trace             Enable trace logging" << std::endl;
+            std::cout << "  --log-async <policy>" << std::endl;
+            std::cout << "                      Write the log from a background thread; when its queue" << std::endl;
+            std::cout << "                      is full, block (wait) or drop messages" << std::endl;
+            std::cout << "  --trace-out <sink>  Trace peripheral output: stdout (default), file:<path>," << std::endl;
+            std::cout << "                      pty (xterm) or null" << std::endl;
+            std::cout << "  --uart-input <src>  UART0 receive source: none (default), pty (xterm)," << std::endl;
+            std::cout << "                      file:<path> (file or named pipe) or stdin" << std::endl;
             std::cout << "  --gdb               Enable GDB server on default port (3333)" << std::endl;
             std::cout << "  --gdb-port <port>   Enable GDB server on specified port" << std::endl;
+            std::cout << "  --engine=<name>     Execution engine: interp (default) or block" << std::endl;
+            std::cout << "  --core <name>       Core model, e.g. cortex-m4 (default: " << ARM_TLM_DEFAULT_CORE << ")" << std::endl;
+            std::cout << "                      Built in:";
+            for (const auto& name : CPUCore::available_cores()) {
+                std::cout << " " << name;
+            }
+            std::cout << std::endl;
+            std::cout << "  --quantum <time>    Temporal decoupling quantum, e.g. 10us (default: 0, off)" << std::endl;
+            std::cout << "  --region <spec>     Memory region name:base:size:attrs, repeatable" << std::endl;
+            std::cout << "                      (default: flash:0x0:512K:rx sram:0x20000000:64K:rwx)" << std::endl;
+            std::cout << "  --clock <freq>      Core clock, e.g. 48MHz (default: 1GHz)" << std::endl;
+            std::cout << "  --flash-wait-states <n>" << std::endl;
+            std::cout << "                      Wait states per flash fetch (default: 0)" << std::endl;
+            std::cout << "  --max-time <time>   Simulated time limit, 0 for none (default: 10s, none with" << std::endl;
+            std::cout << "                      --checkpoint-at)" << std::endl;
+            std::cout << "  --max-instructions <n>" << std::endl;
+            std::cout << "                      Instruction limit (default: none)" << std::endl;
+            std::cout << "  --profile <prefix>  Write per-PC profile to <prefix>.txt and <prefix>.folded" << std::endl;
+            std::cout << "  --register-stats    Count register reads/writes in the performance report" << std::endl;
+            std::cout << "  --inst-trace <file> Write a binary execution trace (tools/trace_decode.py)" << std::endl;
+            std::cout << "  --inst-trace-compress" << std::endl;
+            std::cout << "                      Compress the execution trace in blocks" << std::endl;
+            std::cout << "  --save-checkpoint <file>" << std::endl;
+            std::cout << "                      Save a checkpoint when the run stops" << std::endl;
+            std::cout << "  --checkpoint-at <time>" << std::endl;
+            std::cout << "                      Stop (and save) at this simulation time, e.g. 20ms" << std::endl;
+            std::cout << "  --restore-checkpoint <file>" << std::endl;
+            std::cout << "                      Resume from a checkpoint instead of booting" << std::endl;
+            std::cout << "  --batch <list>      Run every image in <list> (one path per line) with the" << std::endl;
+            std::cout << "                      other options, each in its own worker process" << std::endl;
+            std::cout << "  -j <n>              Parallel batch workers (default: number of CPUs)" << std::endl;
+            std::cout << "  --batch-results <file>" << std::endl;
+            std::cout << "                      JSON Lines results (default: batch_results.jsonl)" << std::endl;
+            std::cout << "  --batch-logs <dir>  Keep each test's console output and log in <dir>" << std::endl;
             std::cout << "  --help, -h          Show this help" << std::endl;
             return 0;
         }
     }
     
-    try {
-        // Create simulator
-        Simulator sim("simulator", hex_file);
-        
-        // Configure logging
-        sim.set_log_level(log_level);
-        sim.set_log_file(log_file);
-        sim.enable_performance_monitoring(true);
-        
-        // Configure GDB server if requested
-        if (gdb_enabled) {
-            sim.enable_gdb_server(gdb_port);
-            std::cout << "GDB server enabled on port " << gdb_port << std::endl;
+    if (opt.checkpoint_at != SC_ZERO_TIME && opt.max_time_given && opt.max_time != SC_ZERO_TIME &&
+        opt.checkpoint_at > opt.max_time) {
+        std::cerr << "--checkpoint-at " << opt.checkpoint_at.to_string() << " is after --max-time "
+                  << opt.max_time.to_string() << std::endl;
+        return 1;
+    }
+
+    if (!CPUCore::has_core(opt.core)) {
+        std::cerr << "Unknown or not built core: " << opt.core << " (available:";
+        for (const auto& name : CPUCore::available_cores()) {
+            std::cerr << " " << name;
         }
-        
-        // Run simulation
-        std::cout << "Starting simulation..." << std::endl;
-        if (!hex_file.empty()) {
-            std::cout << "Loading HEX file: " << hex_file << std::endl;
+        std::cerr << ")" << std::endl;
+        return 1;
+    }
+
+    if (!batch_list.empty()) {
+        if (opt.gdb_enabled) {
+            std::cerr << "--gdb cannot be used with --batch" << std::endl;
+            return 1;
         }
-        
-        if (gdb_enabled) {
-            std::cout << "Waiting for GDB connection..." << std::endl;
-            std::cout << "Connect with: arm-none-eabi-gdb -ex 'target remote localhost:" << gdb_port << "'" << std::endl;
-            // Run indefinitely when GDB is enabled to allow debugging
-            sim.run_simulation(SC_ZERO_TIME);  // Run indefinitely 
-        } else {
-            sim.run_simulation(sc_time(10000000, SC_US));  // Run for 100ms  
+        // Workers share one terminal and standard input
+        if (opt.uart_input == "pty" || opt.uart_input == "stdin") {
+            std::cerr << "--uart-input " << opt.uart_input << " cannot be used with --batch" << std::endl;
+            return 1;
         }
-        
-        std::cout << "Simulation completed." << std::endl;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return 1;
+        // Per-test outputs are named after the test's log prefix
+        if (batch_logs.empty() && (!opt.profile_prefix.empty() || !opt.save_checkpoint.empty())) {
+            std::cerr << "--profile and --save-checkpoint need --batch-logs with --batch" << std::endl;
+            return 1;
+        }
+        BatchRunner batch(batch_jobs);
+        batch.set_log_dir(batch_logs);
+        return batch.run(batch_list, batch_results,
+                         [&opt](const std::string& image, const std::string& log_prefix) {
+            RunOptions test = opt;
+            test.hex_file = image;
+            test.image_format = IMAGE_AUTO;
+            // Workers have no terminal to open: trace output joins the console output
+            if (test.trace_out == "pty") {
+                test.trace_out = "stdout";
+            }
+            test.log_file = log_prefix.empty() ? "/dev/null" : log_prefix + ".log";
+            // One execution trace per test, kept with its logs
+            if (!test.inst_trace.empty()) {
+                test.inst_trace = log_prefix.empty() ? "" : log_prefix + ".atrc";
+            }
+            if (!test.profile_prefix.empty()) {
+                test.profile_prefix = log_prefix + ".profile";
+            }
+            if (!test.save_checkpoint.empty()) {
+                test.save_checkpoint = log_prefix + ".ckpt";
+            }
+            return run_simulation(test);
+        });
     }
+
+    std::cout << "ARM Cortex-M0 SystemC-TLM Simulator" << std::endl;
+    std::cout << "====================================" << std::endl;
     
-    return 0;
-}
\ No newline at end of file
+    return run_simulation(opt);
+}
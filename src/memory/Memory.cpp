@@ -1,94 +1,352 @@
 #include "Memory.h"
 #include "Log.h"
+#include "Checkpoint.h"
+#include "Compression.h"
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <elf.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-// Simple address map for flat backing store
-static constexpr uint32_t FLASH_BASE   = 0x00000000;
-static constexpr uint32_t FLASH_SIZE   = 0x00080000; // 512KB (per linker)
-static constexpr uint32_t SRAM_BASE    = 0x20000000;
-static constexpr uint32_t SRAM_SIZE    = 0x00010000; // 64KB (per linker)
-// Internal offsets within the flat memory buffer
-static constexpr uint32_t FLASH_OFFSET = 0x00000000;
-static constexpr uint32_t SRAM_OFFSET  = FLASH_OFFSET + FLASH_SIZE; // place SRAM after flash
-
-Memory::Memory(sc_module_name name, uint32_t size) : 
-    sc_module(name), socket("socket"), m_size(size)
+// Host page size used for lazy allocation of region backing store
+static constexpr size_t BACKING_PAGE_SIZE = 4096;
+
+bool MemoryRegion::parse(const std::string& spec, MemoryRegion& region)
 {
-    // Allocate memory
-    m_memory = new uint8_t[m_size];
-    std::memset(m_memory, 0, m_size);
+    std::vector<std::string> parts;
+    std::stringstream ss(spec);
+    std::string part;
+    while (std::getline(ss, part, ':')) {
+        parts.push_back(part);
+    }
+    if (parts.size() != 4 || parts[0].empty()) {
+        return false;
+    }
+
+    try {
+        size_t pos = 0;
+        unsigned long long base = std::stoull(parts[1], &pos, 0);
+        if (pos != parts[1].size()) {
+            return false;
+        }
+        unsigned long long size = std::stoull(parts[2], &pos, 0);
+        std::string suffix = parts[2].substr(pos);
+        if (suffix == "K" || suffix == "k") {
+            size <<= 10;
+        } else if (suffix == "M" || suffix == "m") {
+            size <<= 20;
+        } else if (!suffix.empty()) {
+            return false;
+        }
+        if (size == 0 || base + size > 0x100000000ull) {
+            return false;
+        }
+        region.base = static_cast<uint32_t>(base);
+        region.size = static_cast<uint32_t>(size);
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    region.name = parts[0];
+    region.attributes = 0;
+    for (char c : parts[3]) {
+        switch (c) {
+            case 'r': region.attributes |= MEM_READ; break;
+            case 'w': region.attributes |= MEM_WRITE; break;
+            case 'x': region.attributes |= MEM_EXEC; break;
+            default: return false;
+        }
+    }
+    return (region.attributes & MEM_READ) != 0;
+}
+
+std::string MemoryRegion::attribute_string() const
+{
+    std::string attr;
+    attr += (attributes & MEM_READ) ? 'r' : '-';
+    attr += (attributes & MEM_WRITE) ? 'w' : '-';
+    attr += (attributes & MEM_EXEC) ? 'x' : '-';
+    return attr;
+}
+
+std::vector<MemoryRegion> Memory::default_regions()
+{
+    return {
+        MemoryRegion("flash", 0x00000000, 0x00080000, MEM_READ | MEM_EXEC),              // 512KB (per linker)
+        MemoryRegion("sram",  0x20000000, 0x00010000, MEM_READ | MEM_WRITE | MEM_EXEC),  // 64KB (per linker)
+    };
+}
+
+Memory::Memory(sc_module_name name, const std::vector<MemoryRegion>& regions) : 
+    sc_module(name), socket("socket")
+{
+    const std::vector<MemoryRegion>& config = regions.empty() ? default_regions() : regions;
+
+    for (const auto& region : config) {
+        // Reject overlaps so every address maps to at most one region
+        bool overlaps = false;
+        for (const auto& existing : m_regions) {
+            uint64_t a_end = static_cast<uint64_t>(region.base) + region.size;
+            uint64_t b_end = static_cast<uint64_t>(existing.config.base) + existing.config.size;
+            if (region.base < b_end && existing.config.base < a_end) {
+                LOG_ERROR("Memory region '" + region.name + "' overlaps '" + existing.config.name + "', ignored");
+                overlaps = true;
+                break;
+            }
+        }
+        if (overlaps || region.size == 0) {
+            continue;
+        }
+
+        Region r;
+        r.config = region;
+        r.mapped_size = (static_cast<size_t>(region.size) + BACKING_PAGE_SIZE - 1) & ~(BACKING_PAGE_SIZE - 1);
+        void* ptr = mmap(nullptr, r.mapped_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (ptr == MAP_FAILED) {
+            throw std::runtime_error("Cannot reserve backing store for memory region '" + region.name + "'");
+        }
+        r.data = static_cast<uint8_t*>(ptr);
+
+        auto pos = std::upper_bound(m_regions.begin(), m_regions.end(), region.base,
+                                    [](uint32_t addr, const Region& e) { return addr < e.config.base; });
+        m_regions.insert(pos, r);
+    }
     
     // Bind socket
     socket.register_b_transport(this, &Memory::b_transport);
     socket.register_get_direct_mem_ptr(this, &Memory::get_direct_mem_ptr);
     socket.register_transport_dbg(this, &Memory::transport_dbg);
     
-    LOG_INFO("Memory initialized: " + std::to_string(size) + " bytes");
-    LOG_INFO("Memory map: FLASH[0x" + std::to_string(FLASH_BASE) + 
-             ":0x" + std::to_string(FLASH_BASE + FLASH_SIZE - 1) + 
-             "] -> off 0x" + std::to_string(FLASH_OFFSET) + 
-             ", SRAM[0x" + std::to_string(SRAM_BASE) + 
-             ":0x" + std::to_string(SRAM_BASE + SRAM_SIZE - 1) + 
-             "] -> off 0x" + std::to_string(SRAM_OFFSET) + 
-             ", backing size=0x" + std::to_string(m_size));
+    LOG_INFO("Memory initialized: " + std::to_string(m_regions.size()) + " regions");
+    for (const auto& r : m_regions) {
+        std::stringstream ss;
+        ss << "Memory region " << r.config.name << ": 0x" << std::hex << std::setfill('0')
+           << std::setw(8) << r.config.base << " - 0x" << std::setw(8)
+           << (static_cast<uint64_t>(r.config.base) + r.config.size - 1)
+           << " (size: 0x" << r.config.size << ", " << r.config.attribute_string() << ")";
+        LOG_INFO(ss.str());
+    }
+}
+
+std::vector<MemoryRegion> Memory::regions() const
+{
+    std::vector<MemoryRegion> result;
+    for (const auto& r : m_regions) {
+        result.push_back(r.config);
+    }
+    return result;
 }
 
 Memory::~Memory()
 {
-    delete[] m_memory;
+    for (auto& r : m_regions) {
+        munmap(r.data, r.mapped_size);
+    }
+}
+
+Memory::Region* Memory::find_region(uint32_t address, uint32_t length)
+{
+    auto it = std::upper_bound(m_regions.begin(), m_regions.end(), address,
+                               [](uint32_t addr, const Region& e) { return addr < e.config.base; });
+    if (it == m_regions.begin()) {
+        return nullptr;
+    }
+    --it;
+    uint64_t offset = static_cast<uint64_t>(address) - it->config.base;
+    if (offset + length > it->config.size) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+namespace {
+
+// Read-only view of a whole file, unmapped on scope exit
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filename) {
+        m_fd = open(filename.c_str(), O_RDONLY);
+        if (m_fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(m_fd, &st) != 0) {
+            return;
+        }
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size == 0) {
+            m_ok = true;
+            return;
+        }
+        void* ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+        if (ptr != MAP_FAILED) {
+            m_data = static_cast<const uint8_t*>(ptr);
+            m_ok = true;
+        }
+    }
+    ~MappedFile() {
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+        if (m_fd >= 0) close(m_fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool ok() const { return m_ok; }
+    int fd() const { return m_fd; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    int m_fd { -1 };
+    const uint8_t* m_data { nullptr };
+    size_t m_size { 0 };
+    bool m_ok { false };
+};
+
+// Hex digit lookup: value 0-15, or 0xFF for non-hex characters
+struct HexDigitTable {
+    uint8_t value[256];
+    HexDigitTable() {
+        std::memset(value, 0xFF, sizeof(value));
+        for (int i = 0; i < 10; i++) value['0' + i] = static_cast<uint8_t>(i);
+        for (int i = 0; i < 6; i++) {
+            value['A' + i] = static_cast<uint8_t>(10 + i);
+            value['a' + i] = static_cast<uint8_t>(10 + i);
+        }
+    }
+};
+const HexDigitTable hex_digits;
+
+inline bool parse_hex_byte(const uint8_t* p, uint8_t& out)
+{
+    uint8_t hi = hex_digits.value[p[0]];
+    uint8_t lo = hex_digits.value[p[1]];
+    if ((hi | lo) & 0xF0) {
+        return false;
+    }
+    out = static_cast<uint8_t>((hi << 4) | lo);
+    return true;
+}
+
+std::string hex_address(uint32_t v)
+{
+    std::stringstream ss;
+    ss << "0x" << std::hex << v;
+    return ss.str();
 }
 
-bool Memory::load_hex_file(const std::string& filename)
+} // namespace
+
+bool Memory::load_bytes(uint32_t address, const uint8_t* data, uint32_t length)
 {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    // Copy region by region; loading bypasses attributes so flash can be programmed
+    while (length > 0) {
+        Region* region = find_region(address, 1);
+        if (!region) {
+            LOG_WARNING("Image data outside mapped memory: abs=" + hex_address(address));
+            return false;
+        }
+        uint32_t offset = address - region->config.base;
+        uint32_t chunk = std::min(length, region->config.size - offset);
+        if (data) {
+            std::memcpy(region->data + offset, data, chunk);
+            data += chunk;
+        } else {
+            std::memset(region->data + offset, 0, chunk);
+        }
+        address += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+bool Memory::load_hex_file(const std::string& filename, uint32_t* entry_point)
+{
+    MappedFile file(filename);
+    if (!file.ok()) {
         LOG_ERROR("Cannot open HEX file: " + filename);
         return false;
     }
-    
-    std::string line;
-    uint32_t extended_address = 0;
-    
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] != ':') {
+
+    const uint8_t* p = file.data();
+    const uint8_t* end = p + file.size();
+    uint32_t base_address = 0;
+    uint32_t line_number = 0;
+    uint8_t record[5 + 255];  // count, address(2), type, data, checksum
+
+    while (p < end) {
+        // Find the start of the next record
+        const uint8_t* line = p;
+        while (p < end && *p != '\n') p++;
+        const uint8_t* line_end = p;
+        if (p < end) p++;
+        line_number++;
+
+        while (line < line_end && (*line == ' ' || *line == '\t')) line++;
+        while (line_end > line && (line_end[-1] == '\r' || line_end[-1] == ' ' || line_end[-1] == '\t')) line_end--;
+        if (line == line_end || *line != ':') {
             continue;
         }
-        
-        HexRecord record;
-        if (!parse_hex_line(line, record)) {
-            LOG_ERROR("Invalid HEX line: " + line);
+        line++;
+
+        // Decode all bytes of the record in place and verify the checksum
+        size_t digits = static_cast<size_t>(line_end - line);
+        uint8_t byte_count;
+        bool valid = digits >= 10 && parse_hex_byte(line, byte_count) &&
+                     digits == 2u * (5u + byte_count);
+        uint8_t sum = 0;
+        for (size_t i = 0; valid && i < 5u + byte_count; i++) {
+            valid = parse_hex_byte(line + 2 * i, record[i]);
+            sum += record[i];
+        }
+        if (!valid || sum != 0) {
+            LOG_ERROR("Invalid HEX record at line " + std::to_string(line_number) + " of " + filename);
             continue;
         }
-        
-        switch (record.record_type) {
-            case 0x00: // Data record
-            {
-                uint32_t abs_addr = extended_address + record.address;
-                // Translate absolute address into backing store offset
-                uint32_t dst_off = 0xFFFFFFFF;
-                if (abs_addr >= FLASH_BASE && abs_addr < FLASH_BASE + FLASH_SIZE) {
-                    dst_off = FLASH_OFFSET + (abs_addr - FLASH_BASE);
-                } else if (abs_addr >= SRAM_BASE && abs_addr < SRAM_BASE + SRAM_SIZE) {
-                    dst_off = SRAM_OFFSET + (abs_addr - SRAM_BASE);
-                }
 
-                if (dst_off != 0xFFFFFFFF && dst_off + record.byte_count <= m_size) {
-                    std::memcpy(&m_memory[dst_off], record.data.data(), record.byte_count);
-                    LOG_DEBUG("HEX load: " + std::to_string(record.byte_count) + " bytes @abs 0x" +
-                              std::to_string(abs_addr) + " -> off 0x" + std::to_string(dst_off));
-                } else {
-                    LOG_WARNING("HEX data outside mapped memory: abs=0x" + std::to_string(abs_addr));
+        uint16_t offset = static_cast<uint16_t>((record[1] << 8) | record[2]);
+        uint8_t type = record[3];
+        const uint8_t* data = &record[4];
+
+        switch (type) {
+            case 0x00: // Data record
+                if (!load_bytes(base_address + offset, data, byte_count)) {
+                    LOG_ERROR("HEX record at " + hex_address(base_address + offset) + " (line " +
+                              std::to_string(line_number) + ") outside mapped memory: " + filename);
+                    return false;
                 }
                 break;
-            }
             case 0x01: // End of file
                 LOG_INFO("HEX file loaded successfully");
                 return true;
+            case 0x02: // Extended segment address
+                if (byte_count == 2) {
+                    base_address = static_cast<uint32_t>((data[0] << 8) | data[1]) << 4;
+                }
+                break;
+            case 0x03: // Start segment address (CS:IP)
+                if (byte_count == 4 && entry_point) {
+                    uint32_t cs = (data[0] << 8) | data[1];
+                    uint32_t ip = (data[2] << 8) | data[3];
+                    *entry_point = (cs << 4) + ip;
+                }
+                break;
             case 0x04: // Extended linear address
-                if (record.byte_count == 2) {
-                    extended_address = (record.data[0] << 24) | (record.data[1] << 16);
+                if (byte_count == 2) {
+                    base_address = static_cast<uint32_t>((data[0] << 8) | data[1]) << 16;
+                }
+                break;
+            case 0x05: // Start linear address
+                if (byte_count == 4 && entry_point) {
+                    *entry_point = (static_cast<uint32_t>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
                 }
                 break;
         }
@@ -98,6 +356,160 @@ bool Memory::load_hex_file(const std::string& filename)
     return true;
 }
 
+bool Memory::load_bin_file(const std::string& filename, uint32_t base_address)
+{
+    MappedFile file(filename);
+    if (!file.ok()) {
+        LOG_ERROR("Cannot open binary file: " + filename);
+        return false;
+    }
+    if (file.size() == 0) {
+        LOG_WARNING("Binary file is empty: " + filename);
+        return true;
+    }
+
+    Region* region = find_region(base_address, 1);
+    if (!region || file.size() > region->config.size - (base_address - region->config.base)) {
+        LOG_ERROR("Binary image " + filename + " does not fit in memory at " + hex_address(base_address));
+        return false;
+    }
+
+    // Map the file straight over the region's backing store. MAP_PRIVATE keeps
+    // the file read-only: pages are shared with the page cache until something
+    // (e.g. a GDB breakpoint) writes them, which copies just that page.
+    uint32_t offset = base_address - region->config.base;
+    if (offset % BACKING_PAGE_SIZE == 0) {
+        void* ptr = mmap(region->data + offset, file.size(), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED, file.fd(), 0);
+        if (ptr != MAP_FAILED) {
+            LOG_INFO("Binary image mapped: " + std::to_string(file.size()) + " bytes at " +
+                     hex_address(base_address) + " (" + region->config.name + ")");
+            return true;
+        }
+        LOG_WARNING("mmap of " + filename + " failed, copying instead");
+    }
+
+    if (!load_bytes(base_address, file.data(), static_cast<uint32_t>(file.size()))) {
+        LOG_ERROR("Binary image does not fit in mapped memory: " + filename);
+        return false;
+    }
+    LOG_INFO("Binary image loaded: " + std::to_string(file.size()) + " bytes at " + hex_address(base_address));
+    return true;
+}
+
+bool Memory::load_elf_file(const std::string& filename, uint32_t* entry_point, SymbolTable* symbols)
+{
+    MappedFile file(filename);
+    if (!file.ok()) {
+        LOG_ERROR("Cannot open ELF file: " + filename);
+        return false;
+    }
+
+    const uint8_t* image = file.data();
+    size_t size = file.size();
+    if (size < sizeof(Elf32_Ehdr) || std::memcmp(image, ELFMAG, SELFMAG) != 0) {
+        LOG_ERROR("Not an ELF file: " + filename);
+        return false;
+    }
+
+    Elf32_Ehdr ehdr;
+    std::memcpy(&ehdr, image, sizeof(ehdr));
+    if (ehdr.e_ident[EI_CLASS] != ELFCLASS32 || ehdr.e_ident[EI_DATA] != ELFDATA2LSB || ehdr.e_machine != EM_ARM) {
+        LOG_ERROR("Unsupported ELF (need 32-bit little-endian ARM): " + filename);
+        return false;
+    }
+
+    // Place PT_LOAD segments at their load (physical) address, so initialized
+    // data lands in flash where the startup code copies it from
+    unsigned int segments = 0;
+    for (unsigned int i = 0; i < ehdr.e_phnum; i++) {
+        size_t ph_off = ehdr.e_phoff + static_cast<size_t>(i) * ehdr.e_phentsize;
+        if (ehdr.e_phentsize < sizeof(Elf32_Phdr) || ph_off + sizeof(Elf32_Phdr) > size) {
+            LOG_ERROR("Truncated ELF program header table: " + filename);
+            return false;
+        }
+        Elf32_Phdr phdr;
+        std::memcpy(&phdr, image + ph_off, sizeof(phdr));
+        if (phdr.p_type != PT_LOAD || phdr.p_memsz == 0) {
+            continue;
+        }
+        if (static_cast<size_t>(phdr.p_offset) + phdr.p_filesz > size) {
+            LOG_ERROR("ELF segment outside file: " + filename);
+            return false;
+        }
+
+        if (phdr.p_filesz > 0 && !load_bytes(phdr.p_paddr, image + phdr.p_offset, phdr.p_filesz)) {
+            LOG_ERROR("ELF segment at " + hex_address(phdr.p_paddr) + " outside mapped memory: " + filename);
+            return false;
+        }
+        // The zero-filled tail (.bss) lives at the run (virtual) address; only
+        // the initialized part has a separate load image in flash
+        if (phdr.p_memsz > phdr.p_filesz &&
+            !load_bytes(phdr.p_vaddr + phdr.p_filesz, nullptr, phdr.p_memsz - phdr.p_filesz)) {
+            LOG_ERROR("ELF segment at " + hex_address(phdr.p_vaddr) + " outside mapped memory: " + filename);
+            return false;
+        }
+        segments++;
+
+        std::stringstream ss;
+        ss << "ELF segment: paddr 0x" << std::hex << phdr.p_paddr << " filesz 0x" << phdr.p_filesz
+           << " memsz 0x" << phdr.p_memsz;
+        LOG_DEBUG(ss.str());
+    }
+
+    if (entry_point) {
+        *entry_point = ehdr.e_entry;
+    }
+
+    // Capture the symbol table (functions and objects; ARM mapping symbols skipped)
+    if (symbols && ehdr.e_shentsize >= sizeof(Elf32_Shdr) &&
+        ehdr.e_shoff + static_cast<size_t>(ehdr.e_shnum) * ehdr.e_shentsize <= size) {
+        for (unsigned int i = 0; i < ehdr.e_shnum; i++) {
+            Elf32_Shdr shdr;
+            std::memcpy(&shdr, image + ehdr.e_shoff + static_cast<size_t>(i) * ehdr.e_shentsize, sizeof(shdr));
+            if (shdr.sh_type != SHT_SYMTAB || shdr.sh_link >= ehdr.e_shnum ||
+                static_cast<size_t>(shdr.sh_offset) + shdr.sh_size > size) {
+                continue;
+            }
+            Elf32_Shdr strtab;
+            std::memcpy(&strtab, image + ehdr.e_shoff + static_cast<size_t>(shdr.sh_link) * ehdr.e_shentsize, sizeof(strtab));
+            if (static_cast<size_t>(strtab.sh_offset) + strtab.sh_size > size) {
+                continue;
+            }
+            const char* names = reinterpret_cast<const char*>(image + strtab.sh_offset);
+
+            size_t count = shdr.sh_size / sizeof(Elf32_Sym);
+            for (size_t n = 0; n < count; n++) {
+                Elf32_Sym sym;
+                std::memcpy(&sym, image + shdr.sh_offset + n * sizeof(Elf32_Sym), sizeof(sym));
+                unsigned int type = ELF32_ST_TYPE(sym.st_info);
+                if ((type != STT_FUNC && type != STT_OBJECT && type != STT_NOTYPE) ||
+                    sym.st_shndx == SHN_UNDEF || sym.st_name >= strtab.sh_size) {
+                    continue;
+                }
+                const char* name = names + sym.st_name;
+                size_t max_len = strtab.sh_size - sym.st_name;
+                size_t len = strnlen(name, max_len);
+                if (len == 0 || len == max_len || name[0] == '$') {
+                    continue;
+                }
+                bool is_function = (type == STT_FUNC);
+                uint32_t address = is_function ? (sym.st_value & ~1u) : sym.st_value;
+                symbols->add(std::string(name, len), address, sym.st_size, is_function);
+            }
+        }
+        symbols->finalize();
+    }
+
+    std::stringstream ss;
+    ss << "ELF file loaded: " << segments << " segments, entry 0x" << std::hex << ehdr.e_entry;
+    if (symbols) {
+        ss << std::dec << ", " << symbols->size() << " symbols";
+    }
+    LOG_INFO(ss.str());
+    return true;
+}
+
 void Memory::b_transport(tlm_generic_payload& trans, sc_time& delay)
 {
     if (trans.get_command() == TLM_READ_COMMAND) {
@@ -124,22 +536,14 @@ void Memory::handle_read(tlm_generic_payload& trans)
 {
     uint32_t abs_addr = trans.get_address();
     uint32_t length = trans.get_data_length();
-    uint8_t* data_ptr = trans.get_data_ptr();
-
-    // Translate absolute to backing-store offset
-    uint32_t off = 0xFFFFFFFF;
-    if (abs_addr >= FLASH_BASE && abs_addr < FLASH_BASE + FLASH_SIZE) {
-        off = FLASH_OFFSET + (abs_addr - FLASH_BASE);
-    } else if (abs_addr >= SRAM_BASE && abs_addr < SRAM_BASE + SRAM_SIZE) {
-        off = SRAM_OFFSET + (abs_addr - SRAM_BASE);
-    }
 
-    if (off == 0xFFFFFFFF || (off + length) > m_size) {
+    Region* region = find_region(abs_addr, length);
+    if (!region || !(region->config.attributes & MEM_READ)) {
         trans.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
         return;
     }
 
-    std::memcpy(data_ptr, &m_memory[off], length);
+    std::memcpy(trans.get_data_ptr(), region->data + (abs_addr - region->config.base), length);
     trans.set_response_status(TLM_OK_RESPONSE);
 }
 
@@ -147,152 +551,182 @@ void Memory::handle_write(tlm_generic_payload& trans)
 {
     uint32_t abs_addr = trans.get_address();
     uint32_t length = trans.get_data_length();
-    uint8_t* data_ptr = trans.get_data_ptr();
 
-    // Translate absolute to backing-store offset
-    uint32_t off = 0xFFFFFFFF;
-    if (abs_addr >= FLASH_BASE && abs_addr < FLASH_BASE + FLASH_SIZE) {
-        off = FLASH_OFFSET + (abs_addr - FLASH_BASE);
-    } else if (abs_addr >= SRAM_BASE && abs_addr < SRAM_BASE + SRAM_SIZE) {
-        off = SRAM_OFFSET + (abs_addr - SRAM_BASE);
-    }
-
-    if (off == 0xFFFFFFFF || (off + length) > m_size) {
+    Region* region = find_region(abs_addr, length);
+    if (!region) {
         trans.set_response_status(TLM_ADDRESS_ERROR_RESPONSE);
         return;
     }
+    if (!(region->config.attributes & MEM_WRITE)) {
+        trans.set_response_status(TLM_COMMAND_ERROR_RESPONSE);  // Read-only region
+        return;
+    }
 
-    std::memcpy(&m_memory[off], data_ptr, length);
+    std::memcpy(region->data + (abs_addr - region->config.base), trans.get_data_ptr(), length);
     trans.set_response_status(TLM_OK_RESPONSE);
 }
 
-bool Memory::is_valid_address(uint32_t address, uint32_t length)
-{
-    // Legacy helper (not used by TLM path anymore), keep simple bounds on backing store
-    return (address + length) <= m_size;
-}
-
 uint32_t Memory::read_word(uint32_t address)
 {
-    // Treat address as absolute; translate
-    uint32_t off = 0xFFFFFFFF;
-    if (address >= FLASH_BASE && address < FLASH_BASE + FLASH_SIZE) {
-        off = FLASH_OFFSET + (address - FLASH_BASE);
-    } else if (address >= SRAM_BASE && address < SRAM_BASE + SRAM_SIZE) {
-        off = SRAM_OFFSET + (address - SRAM_BASE);
-    }
-    if (off == 0xFFFFFFFF || off + 4 > m_size) {
+    Region* region = find_region(address, 4);
+    if (!region) {
         return 0;
     }
 
-    return *reinterpret_cast<uint32_t*>(&m_memory[off]);
+    uint32_t value;
+    std::memcpy(&value, region->data + (address - region->config.base), sizeof(value));
+    return value;
 }
 
 void Memory::write_word(uint32_t address, uint32_t data)
 {
-    uint32_t off = 0xFFFFFFFF;
-    if (address >= FLASH_BASE && address < FLASH_BASE + FLASH_SIZE) {
-        off = FLASH_OFFSET + (address - FLASH_BASE);
-    } else if (address >= SRAM_BASE && address < SRAM_BASE + SRAM_SIZE) {
-        off = SRAM_OFFSET + (address - SRAM_BASE);
-    }
-    if (off == 0xFFFFFFFF || off + 4 > m_size) {
+    Region* region = find_region(address, 4);
+    if (!region) {
         return;
     }
 
-    *reinterpret_cast<uint32_t*>(&m_memory[off]) = data;
+    std::memcpy(region->data + (address - region->config.base), &data, sizeof(data));
 }
 
 bool Memory::get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data)
 {
-    uint32_t abs_addr = trans.get_address();
-
-    // Provide DMI for FLASH and SRAM regions. We expose the entire region for
-    // whichever space the address falls into.
-    if (abs_addr >= FLASH_BASE && abs_addr < FLASH_BASE + FLASH_SIZE) {
-        dmi_data.set_start_address(FLASH_BASE);
-        dmi_data.set_end_address(FLASH_BASE + FLASH_SIZE - 1);
-        dmi_data.set_dmi_ptr(reinterpret_cast<unsigned char*>(m_memory + FLASH_OFFSET));
-        dmi_data.set_granted_access(tlm_dmi::DMI_ACCESS_READ); // Flash is read-only
-        dmi_data.set_read_latency(sc_time(1, SC_NS));
-        dmi_data.set_write_latency(sc_time(1, SC_NS));
-        return true;
-    }
-
-    if (abs_addr >= SRAM_BASE && abs_addr < SRAM_BASE + SRAM_SIZE) {
-        dmi_data.set_start_address(SRAM_BASE);
-        dmi_data.set_end_address(SRAM_BASE + SRAM_SIZE - 1);
-        dmi_data.set_dmi_ptr(reinterpret_cast<unsigned char*>(m_memory + SRAM_OFFSET));
-        dmi_data.set_granted_access(tlm_dmi::DMI_ACCESS_READ_WRITE); // SRAM R/W
-        dmi_data.set_read_latency(sc_time(1, SC_NS));
-        dmi_data.set_write_latency(sc_time(1, SC_NS));
-        return true;
+    // Grant the whole region the address falls into
+    Region* region = find_region(trans.get_address(), 1);
+    if (!region || !(region->config.attributes & MEM_READ)) {
+        return false;  // Unmapped: no DMI
     }
 
-    // Peripherals / unmapped: no DMI
-    return false;
+    dmi_data.set_start_address(region->config.base);
+    dmi_data.set_end_address(static_cast<uint64_t>(region->config.base) + region->config.size - 1);
+    dmi_data.set_dmi_ptr(reinterpret_cast<unsigned char*>(region->data));
+    dmi_data.set_granted_access((region->config.attributes & MEM_WRITE) ? tlm_dmi::DMI_ACCESS_READ_WRITE
+                                                                        : tlm_dmi::DMI_ACCESS_READ);
+    // Access cycles are part of the CPU's per-instruction cycle table
+    dmi_data.set_read_latency(SC_ZERO_TIME);
+    dmi_data.set_write_latency(SC_ZERO_TIME);
+    return true;
 }
 
 unsigned int Memory::transport_dbg(tlm_generic_payload& trans)
 {
     uint32_t abs_addr = trans.get_address();
     uint32_t length = trans.get_data_length();
-    uint8_t* data_ptr = trans.get_data_ptr();
 
-    uint32_t off = 0xFFFFFFFF;
-    if (abs_addr >= FLASH_BASE && abs_addr < FLASH_BASE + FLASH_SIZE) {
-        off = FLASH_OFFSET + (abs_addr - FLASH_BASE);
-    } else if (abs_addr >= SRAM_BASE && abs_addr < SRAM_BASE + SRAM_SIZE) {
-        off = SRAM_OFFSET + (abs_addr - SRAM_BASE);
-    }
-    if (off == 0xFFFFFFFF || off + length > m_size) {
+    // Debug accesses ignore region attributes (GDB may patch flash)
+    Region* region = find_region(abs_addr, length);
+    if (!region) {
         return 0;
     }
 
+    uint8_t* mem = region->data + (abs_addr - region->config.base);
     if (trans.get_command() == TLM_READ_COMMAND) {
-        std::memcpy(data_ptr, &m_memory[off], length);
+        std::memcpy(trans.get_data_ptr(), mem, length);
     } else if (trans.get_command() == TLM_WRITE_COMMAND) {
-        std::memcpy(&m_memory[off], data_ptr, length);
+        std::memcpy(mem, trans.get_data_ptr(), length);
     }
 
     return length;
 }
 
-bool Memory::parse_hex_line(const std::string& line, HexRecord& record)
+void Memory::save_state(CheckpointWriter& out) const
 {
-    if (line.length() < 11 || line[0] != ':') {
-        return false;
-    }
-    
-    try {
-        record.byte_count = std::stoi(line.substr(1, 2), nullptr, 16);
-        record.address = std::stoi(line.substr(3, 4), nullptr, 16);
-        record.record_type = std::stoi(line.substr(7, 2), nullptr, 16);
-        
-        record.data.clear();
-        for (int i = 0; i < record.byte_count; i++) {
-            int pos = 9 + i * 2;
-            if (pos + 1 < line.length()) {
-                uint8_t byte = std::stoi(line.substr(pos, 2), nullptr, 16);
-                record.data.push_back(byte);
-            }
+    static const uint32_t END_OF_PAGES = 0xFFFFFFFF;
+    const size_t host_page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    out.section("MEM ");
+    out.put_u32(static_cast<uint32_t>(m_regions.size()));
+    std::vector<uint8_t> compressed;
+    size_t saved_pages = 0;
+    for (const auto& r : m_regions) {
+        out.put_string(r.config.name);
+        out.put_u32(r.config.base);
+        out.put_u32(r.config.size);
+
+        // Pages never touched are not resident and read as zero: skip them
+        // without faulting them in
+        std::vector<unsigned char> resident((r.mapped_size + host_page - 1) / host_page, 1);
+        if (mincore(r.data, r.mapped_size, resident.data()) != 0) {
+            std::fill(resident.begin(), resident.end(), 1);
         }
-        
-        int checksum_pos = 9 + record.byte_count * 2;
-        if (checksum_pos + 1 < line.length()) {
-            record.checksum = std::stoi(line.substr(checksum_pos, 2), nullptr, 16);
+
+        for (size_t offset = 0; offset < r.mapped_size; offset += BACKING_PAGE_SIZE) {
+            if (!(resident[offset / host_page] & 1)) {
+                continue;
+            }
+            const uint8_t* page = r.data + offset;
+            bool zero = true;
+            for (size_t i = 0; i < BACKING_PAGE_SIZE; i += sizeof(uint64_t)) {
+                uint64_t word;
+                std::memcpy(&word, page + i, sizeof(word));
+                if (word) {
+                    zero = false;
+                    break;
+                }
+            }
+            if (zero) {
+                continue;
+            }
+
+            compressed.clear();
+            Compression::compress(page, BACKING_PAGE_SIZE, compressed);
+            out.put_u32(static_cast<uint32_t>(offset / BACKING_PAGE_SIZE));
+            out.put_u32(static_cast<uint32_t>(compressed.size()));
+            out.put_bytes(compressed.data(), compressed.size());
+            saved_pages++;
         }
-        
-        return true;
-    } catch (const std::exception& e) {
-        return false;
+        out.put_u32(END_OF_PAGES);
     }
+    LOG_INFO("Memory checkpoint: " + std::to_string(saved_pages) + " pages saved");
 }
 
-uint8_t Memory::hex_char_to_byte(char c)
+bool Memory::restore_state(CheckpointReader& in)
 {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    return 0;
-}
\ No newline at end of file
+    static const uint32_t END_OF_PAGES = 0xFFFFFFFF;
+
+    if (!in.section("MEM ")) {
+        return false;
+    }
+    if (in.get_u32() != m_regions.size()) {
+        LOG_ERROR("Checkpoint memory map does not match the configured regions");
+        return false;
+    }
+
+    std::vector<uint8_t> compressed;
+    for (auto& r : m_regions) {
+        std::string name = in.get_string();
+        uint32_t base = in.get_u32();
+        uint32_t size = in.get_u32();
+        if (!in.ok() || base != r.config.base || size != r.config.size) {
+            LOG_ERROR("Checkpoint region '" + name + "' does not match region '" + r.config.name + "'");
+            return false;
+        }
+
+        // Start from all-zero memory: drop loaded images and any file mapping
+        void* ptr = mmap(r.data, r.mapped_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+        if (ptr == MAP_FAILED) {
+            LOG_ERROR("Cannot reset memory region '" + r.config.name + "'");
+            return false;
+        }
+
+        while (true) {
+            uint32_t index = in.get_u32();
+            if (!in.ok() || index == END_OF_PAGES) {
+                break;
+            }
+            uint32_t length = in.get_u32();
+            size_t offset = static_cast<size_t>(index) * BACKING_PAGE_SIZE;
+            if (offset >= r.mapped_size || length > 2 * BACKING_PAGE_SIZE) {
+                LOG_ERROR("Corrupt checkpoint page in region '" + r.config.name + "'");
+                return false;
+            }
+            compressed.resize(length);
+            if (!in.get_bytes(compressed.data(), length) ||
+                !Compression::decompress(compressed.data(), length, r.data + offset, BACKING_PAGE_SIZE)) {
+                LOG_ERROR("Corrupt checkpoint page in region '" + r.config.name + "'");
+                return false;
+            }
+        }
+    }
+    return in.ok();
+}
@@ -6,56 +6,96 @@
 #include <tlm_utils/simple_target_socket.h>
 #include <vector>
 #include <string>
+#include "SymbolTable.h"
 
 using namespace sc_core;
 using namespace tlm;
 
+class CheckpointWriter;
+class CheckpointReader;
+
+// Memory region access attributes
+enum MemoryAttribute : uint8_t {
+    MEM_READ  = 0x1,
+    MEM_WRITE = 0x2,
+    MEM_EXEC  = 0x4
+};
+
+// One contiguous region of the memory map (flash, SRAM bank, ...)
+struct MemoryRegion {
+    std::string name;
+    uint32_t base;
+    uint32_t size;
+    uint8_t attributes;  // MemoryAttribute flags
+
+    MemoryRegion(const std::string& n = "", uint32_t b = 0, uint32_t s = 0, uint8_t attr = MEM_READ | MEM_WRITE)
+        : name(n), base(b), size(s), attributes(attr) {}
+
+    // Parse "name:base:size:attrs", e.g. "flash:0x0:2M:rx" or "sram1:0x20000000:128K:rw"
+    static bool parse(const std::string& spec, MemoryRegion& region);
+    std::string attribute_string() const;
+};
+
 class Memory : public sc_module, public tlm_fw_transport_if<>
 {
 public:
     // TLM target socket
     tlm_utils::simple_target_socket<Memory> socket;
 
-    // Constructor
+    // Constructor: regions must not overlap; an empty list selects default_regions()
     SC_HAS_PROCESS(Memory);
-    Memory(sc_module_name name, uint32_t size = 0x100000); // Default 1MB
-    
+    Memory(sc_module_name name, const std::vector<MemoryRegion>& regions = std::vector<MemoryRegion>());
+
     // Destructor
     ~Memory();
 
-    // Load Intel HEX file
-    bool load_hex_file(const std::string& filename);
-    
+    // Default map matching the test linker scripts: 512KB flash at 0, 64KB SRAM at 0x20000000
+    static std::vector<MemoryRegion> default_regions();
+    // Regions in use, sorted by base address
+    std::vector<MemoryRegion> regions() const;
+
+    // Program loaders. Loading bypasses region attributes so flash can be programmed.
+    // Intel HEX; a start address record (type 03/05) is returned in entry_point
+    bool load_hex_file(const std::string& filename, uint32_t* entry_point = nullptr);
+    // Raw binary, mapped copy-on-write straight into the region at base_address
+    bool load_bin_file(const std::string& filename, uint32_t base_address = 0);
+    // ELF: PT_LOAD segments at their load address, plus entry point and symbols
+    bool load_elf_file(const std::string& filename, uint32_t* entry_point = nullptr,
+                       SymbolTable* symbols = nullptr);
+
+    // Checkpoint support: only pages holding non-zero data are written, each
+    // compressed. Restore requires the same region layout.
+    void save_state(CheckpointWriter& out) const;
+    bool restore_state(CheckpointReader& in);
+
     // Direct memory access (for debugging)
     uint32_t read_word(uint32_t address);
     void write_word(uint32_t address, uint32_t data);
-    
+
     // TLM-2 interface methods
     virtual void b_transport(tlm_generic_payload& trans, sc_time& delay);
     virtual tlm_sync_enum nb_transport_fw(tlm_generic_payload& trans, tlm_phase& phase, sc_time& delay);
     virtual bool get_direct_mem_ptr(tlm_generic_payload& trans, tlm_dmi& dmi_data);
     virtual unsigned int transport_dbg(tlm_generic_payload& trans);
-    
+
 private:
-    uint8_t* m_memory;
-    uint32_t m_size;
-    
+    // Backing store for one region. Host memory is reserved up front but only
+    // committed by the OS page by page (4KB) on first touch, so untouched
+    // parts of a large flash or SRAM cost nothing. Being contiguous, a whole
+    // region can be handed out as one DMI grant.
+    struct Region {
+        MemoryRegion config;
+        uint8_t* data;
+        size_t mapped_size;  // config.size rounded up to whole pages
+    };
+    std::vector<Region> m_regions;  // Sorted by base address
+
     // Helper methods
-    bool is_valid_address(uint32_t address, uint32_t length);
+    Region* find_region(uint32_t address, uint32_t length);
     void handle_read(tlm_generic_payload& trans);
     void handle_write(tlm_generic_payload& trans);
-    
-    // Intel HEX parsing
-    struct HexRecord {
-        uint8_t byte_count;
-        uint16_t address;
-        uint8_t record_type;
-        std::vector<uint8_t> data;
-        uint8_t checksum;
-    };
-    
-    bool parse_hex_line(const std::string& line, HexRecord& record);
-    uint8_t hex_char_to_byte(char c);
+    // Copy (or zero, when data is null) image bytes into the backing store
+    bool load_bytes(uint32_t address, const uint8_t* data, uint32_t length);
 };
 
-#endif // MEMORY_H
\ No newline at end of file
+#endif // MEMORY_H
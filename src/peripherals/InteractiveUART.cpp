@@ -1,5 +1,6 @@
 #include "InteractiveUART.h"
 #include "Log.h"
+#include "Checkpoint.h"
 #include <cstdio>
 #include <iostream>
 #include <termios.h>
@@ -9,16 +10,25 @@
 #include <cstring>
 #include <sys/wait.h>
 #include <sys/select.h>
+#include <cerrno>
 #include <chrono>
 
-InteractiveUART::InteractiveUART(sc_module_name name, int uart_id) :
+InteractiveUART::InteractiveUART(sc_module_name name, int uart_id, const std::string& input,
+                                 uint32_t irq_number) :
     sc_module(name),
     socket("socket"),
     irq_socket("irq_socket"),
     m_uart_id(uart_id),
+    m_irq_number(irq_number),
+    m_rx_ring(RX_RING_SIZE),
+    m_rx_notifier("rx_notifier", m_rx_event),
+    m_rx_dropped(false),
     m_pt_slave(-1),
     m_pt_master(-1),
     m_xterm_pid(-1),
+    m_input_fd(-1),
+    m_input_owned(false),
+    m_input_paced(false),
     m_stop_input_thread(false)
 {
     // Register TLM transport methods
@@ -29,16 +39,13 @@ InteractiveUART::InteractiveUART(sc_module_name name, int uart_id) :
     // Initialize registers
     reset_registers();
     
-    // Setup xterm for I/O
-    xterm_setup();
-    
-    // Start input monitoring thread
-    m_input_thread = std::thread(&InteractiveUART::input_monitor_thread, this);
-    
     // Register SystemC process
     SC_THREAD(uart_process);
     
-    LOG_INFO("InteractiveUART" + std::to_string(m_uart_id) + " initialized with xterm support");
+    // Setup the input source (and xterm for I/O)
+    set_input(input);
+    
+    LOG_INFO("InteractiveUART" + std::to_string(m_uart_id) + " initialized");
 }
 
 InteractiveUART::~InteractiveUART()
@@ -48,6 +55,10 @@ InteractiveUART::~InteractiveUART()
     if (m_input_thread.joinable()) {
         m_input_thread.join();
     }
+    if (m_input_owned) {
+        close(m_input_fd);
+    }
+    m_input_fd = -1;
     
     // Clean up xterm
     xterm_kill();
@@ -55,6 +66,54 @@ InteractiveUART::~InteractiveUART()
     LOG_INFO("InteractiveUART" + std::to_string(m_uart_id) + " destroyed");
 }
 
+bool InteractiveUART::set_input(const std::string& input)
+{
+    if (m_input_thread.joinable() || m_input_fd != -1) {
+        LOG_ERROR("UART" + std::to_string(m_uart_id) + " input already selected");
+        return false;
+    }
+    if (!open_input(input)) {
+        return false;
+    }
+    if (m_input_fd != -1) {
+        m_rx_notifier.keep_alive(true);
+        m_input_thread = std::thread(&InteractiveUART::input_monitor_thread, this);
+    }
+    LOG_INFO("UART" + std::to_string(m_uart_id) + " input: " + input);
+    return true;
+}
+
+void InteractiveUART::save_state(CheckpointWriter& out) const
+{
+    out.section("UART");
+    for (int i = 0; i < 16; i++) {
+        out.put_u32(m_registers[i]);
+    }
+    out.put_u32(static_cast<uint32_t>(m_rx_fifo.size()));
+    for (uint8_t ch : m_rx_fifo) {
+        out.put_u8(ch);
+    }
+}
+
+bool InteractiveUART::restore_state(CheckpointReader& in)
+{
+    if (!in.section("UART")) {
+        return false;
+    }
+    for (int i = 0; i < 16; i++) {
+        m_registers[i] = in.get_u32();
+    }
+    uint32_t count = in.get_u32();
+    if (count > RX_FIFO_DEPTH) {
+        return false;
+    }
+    m_rx_fifo.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        m_rx_fifo.push_back(in.get_u8());
+    }
+    return in.ok();
+}
+
 void InteractiveUART::b_transport(tlm_generic_payload& trans, sc_time& delay)
 {
     uint32_t address = trans.get_address();
@@ -109,22 +168,24 @@ uint32_t InteractiveUART::read_register(uint32_t address)
     switch (address) {
         case UART_RDR:
             // Read received data
-            {
-                std::lock_guard<std::mutex> lock(m_rx_mutex);
-                if (!m_rx_buffer.empty()) {
-                    value = m_rx_buffer.front();
-                    m_rx_buffer.pop();
-                    
-                    // Clear RXNE flag if buffer is empty
-                    if (m_rx_buffer.empty()) {
-                        m_registers[UART_ISR / 4] &= ~ISR_RXNE;
-                    }
-                    
-                    LOG_DEBUG("UART" + std::to_string(m_uart_id) + " RX: '" + 
-                             char(value) + "' (0x" + std::to_string(value) + ")");
-                } else {
-                    value = 0;
+            if (!m_rx_fifo.empty()) {
+                value = m_rx_fifo.front();
+                m_rx_fifo.pop_front();
+                
+                // Clear RXNE flag if buffer is empty
+                if (m_rx_fifo.empty()) {
+                    m_registers[UART_ISR / 4] &= ~ISR_RXNE;
+                }
+                
+                // Refill from input still waiting in the ring
+                if (!m_rx_ring.empty()) {
+                    m_rx_event.notify(SC_ZERO_TIME);
                 }
+                
+                LOG_DEBUG("UART" + std::to_string(m_uart_id) + " RX: '" + 
+                         char(value) + "' (0x" + std::to_string(value) + ")");
+            } else {
+                value = 0;
             }
             break;
             
@@ -225,35 +286,39 @@ void InteractiveUART::transmit_character(uint8_t ch)
     }
 }
 
-void InteractiveUART::receive_character(uint8_t ch)
+void InteractiveUART::receive_characters()
 {
-    std::lock_guard<std::mutex> lock(m_rx_mutex);
-    
-    // Add character to receive buffer
-    m_rx_buffer.push(ch);
-    
-    // Set RXNE (Receive Data Register Not Empty) flag
-    m_registers[UART_ISR / 4] |= ISR_RXNE;
+    // Move input from the ring into the receive FIFO while it has room;
+    // the rest stays queued until the firmware reads RDR
+    bool received = false;
+    uint8_t ch;
+    while (m_rx_fifo.size() < RX_FIFO_DEPTH && m_rx_ring.pop(ch)) {
+        m_rx_fifo.push_back(ch);
+        received = true;
+        
+        LOG_TRACE("UART" + std::to_string(m_uart_id) + " RX: '" + 
+                 char(ch) + "' (0x" + std::to_string((int)ch) + ")");
+    }
     
-    // Check for buffer overrun
-    if (m_rx_buffer.size() > 16) {  // Arbitrary buffer limit
+    // Input thread had to drop characters
+    if (m_rx_dropped.exchange(false)) {
         m_registers[UART_ISR / 4] |= ISR_ORE;  // Set overrun error
     }
     
-    LOG_TRACE("UART" + std::to_string(m_uart_id) + " RX: '" + 
-             char(ch) + "' (0x" + std::to_string((int)ch) + ")");
+    if (received) {
+        // Set RXNE (Receive Data Register Not Empty) flag
+        m_registers[UART_ISR / 4] |= ISR_RXNE;
+        check_and_trigger_interrupts();
+    }
 }
 
 void InteractiveUART::update_status_flags()
 {
     // Update RXNE flag based on buffer state
-    {
-        std::lock_guard<std::mutex> lock(m_rx_mutex);
-        if (m_rx_buffer.empty()) {
-            m_registers[UART_ISR / 4] &= ~ISR_RXNE;
-        } else {
-            m_registers[UART_ISR / 4] |= ISR_RXNE;
-        }
+    if (m_rx_fifo.empty()) {
+        m_registers[UART_ISR / 4] &= ~ISR_RXNE;
+    } else {
+        m_registers[UART_ISR / 4] |= ISR_RXNE;
     }
 }
 
@@ -290,9 +355,12 @@ void InteractiveUART::check_and_trigger_interrupts()
         uint32_t irq_data = 1;  // Interrupt asserted
         
         trans.set_command(TLM_WRITE_COMMAND);
-        trans.set_address(0);  // Interrupt number or type
+        trans.set_address(m_irq_number);
         trans.set_data_ptr(reinterpret_cast<unsigned char*>(&irq_data));
         trans.set_data_length(4);
+        trans.set_streaming_width(4);
+        trans.set_byte_enable_ptr(nullptr);
+        trans.set_response_status(TLM_INCOMPLETE_RESPONSE);
         
         irq_socket->b_transport(trans, delay);
         
@@ -300,6 +368,37 @@ void InteractiveUART::check_and_trigger_interrupts()
     }
 }
 
+bool InteractiveUART::open_input(const std::string& input)
+{
+    if (input == "pty") {
+        xterm_setup();
+        m_input_fd = m_pt_master;
+        return m_input_fd != -1;
+    }
+    if (input == "none") {
+        return true;
+    }
+    if (input == "stdin") {
+        m_input_fd = STDIN_FILENO;
+        return true;
+    }
+    if (input.rfind("file:", 0) == 0 && input.size() > 5) {
+        // A named pipe blocks here until the feeding script opens it
+        m_input_fd = open(input.c_str() + 5, O_RDONLY);
+        if (m_input_fd == -1) {
+            LOG_ERROR("UART" + std::to_string(m_uart_id) + " cannot open input " + input.substr(5));
+            return false;
+        }
+        m_input_owned = true;
+        // Scripted input is never lost; it waits for ring space instead
+        m_input_paced = true;
+        return true;
+    }
+    LOG_ERROR("UART" + std::to_string(m_uart_id) + " unknown input " + input +
+              " (expected pty, file:<path>, stdin or none)");
+    return false;
+}
+
 void InteractiveUART::xterm_setup()
 {
     m_pt_master = open("/dev/ptmx", O_RDWR);
@@ -388,49 +487,57 @@ void InteractiveUART::input_monitor_thread()
     LOG_INFO("UART" + std::to_string(m_uart_id) + " input monitoring thread started");
     
     while (!m_stop_input_thread) {
-        if (m_pt_master != -1) {
-            fd_set read_fds;
-            FD_ZERO(&read_fds);
-            FD_SET(m_pt_master, &read_fds);
-            
-            struct timeval timeout;
-            timeout.tv_sec = 0;
-            timeout.tv_usec = 100000;  // 100ms timeout
-            
-            int select_result = select(m_pt_master + 1, &read_fds, nullptr, nullptr, &timeout);
-            
-            if (select_result > 0 && FD_ISSET(m_pt_master, &read_fds)) {
-                char buffer[256];
-                ssize_t bytes_read = read(m_pt_master, buffer, sizeof(buffer) - 1);
-                
-                if (bytes_read > 0) {
-                    // Process each received character
-                    for (ssize_t i = 0; i < bytes_read; i++) {
-                        receive_character(buffer[i]);
-                    }
-                    
-                    // Trigger interrupt check
-                    check_and_trigger_interrupts();
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(m_input_fd, &read_fds);
+        
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 100000;  // 100ms timeout, to notice m_stop_input_thread
+        
+        int select_result = select(m_input_fd + 1, &read_fds, nullptr, nullptr, &timeout);
+        if (select_result <= 0 || !FD_ISSET(m_input_fd, &read_fds)) {
+            continue;
+        }
+        
+        uint8_t buffer[256];
+        ssize_t bytes_read = read(m_input_fd, buffer, sizeof(buffer));
+        if (bytes_read < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            LOG_INFO("UART" + std::to_string(m_uart_id) + " input closed");
+            break;
+        }
+        
+        // Hand each character to the SystemC side
+        for (ssize_t i = 0; i < bytes_read; i++) {
+            while (!m_rx_ring.push(buffer[i])) {
+                if (!m_input_paced || m_stop_input_thread) {
+                    m_rx_dropped = true;
+                    break;
                 }
+                // Let the firmware catch up
+                m_rx_notifier.notify();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
             }
-        } else {
-            // Sleep if PTY is not ready
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
+        m_rx_notifier.notify();
     }
     
+    // No more input: let the kernel end on starvation again
+    m_rx_notifier.keep_alive(false);
+    m_rx_notifier.notify();
+    
     LOG_INFO("UART" + std::to_string(m_uart_id) + " input monitoring thread stopped");
 }
 
 void InteractiveUART::uart_process()
 {
     while (true) {
-        wait(10, SC_MS);  // Check every 10ms
-        
-        // Periodic status update and maintenance
-        update_status_flags();
+        // Woken by the input thread, or when the firmware frees FIFO space
+        wait(m_rx_event);
         
-        // This process can be used for additional UART timing,
-        // baud rate simulation, or other periodic tasks
+        receive_characters();
     }
 }
\ No newline at end of file
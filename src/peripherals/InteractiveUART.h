@@ -5,20 +5,28 @@
 #include <tlm>
 #include <tlm_utils/simple_target_socket.h>
 #include <tlm_utils/simple_initiator_socket.h>
-#include <queue>
+#include <deque>
+#include <string>
 #include <thread>
 #include <atomic>
-#include <mutex>
+#include "SpscRing.h"
 
 using namespace sc_core;
 using namespace tlm;
 
+class CheckpointWriter;
+class CheckpointReader;
+
 /**
  * @brief Interactive UART peripheral with xterm I/O support
  * 
  * This UART implementation creates an xterm window for interactive I/O,
  * similar to the Trace module but with full bidirectional communication.
  * It supports both character output and input with interrupt generation.
+ *
+ * Input is read by an OS thread (from the xterm, a file/pipe or stdin) and
+ * handed to the SystemC side through a lock-free ring; the thread raises an
+ * async update so uart_process only wakes when bytes have arrived.
  */
 class InteractiveUART : public sc_module
 {
@@ -29,16 +37,35 @@ public:
     // TLM initiator socket for interrupt signaling
     tlm_utils::simple_initiator_socket<InteractiveUART> irq_socket;
 
-    // Constructor
+    // Constructor. Interrupts are raised as writes to irq_socket at address
+    // irq_number (see NVIC::irq_socket).
     SC_HAS_PROCESS(InteractiveUART);
-    InteractiveUART(sc_module_name name, int uart_id = 0);
+    InteractiveUART(sc_module_name name, int uart_id = 0, const std::string& input = "none",
+                    uint32_t irq_number = 1);
 
     // Destructor
     ~InteractiveUART();
 
+    // Select where received characters come from; call once, before the
+    // simulation starts:
+    //   "pty"         - an xterm window, which also shows the output
+    //   "file:<path>" - a file or named pipe, for scripted headless runs
+    //   "stdin"       - the simulator's standard input
+    //   "none"        - nothing is ever received (default)
+    // Without an xterm, transmitted characters go to the console. While the
+    // input is open the kernel keeps running even with no event pending, so a
+    // core sleeping in WFI waits for input instead of ending the simulation.
+    bool set_input(const std::string& input);
+
+    // Checkpoint support: registers and the receive FIFO. Input still queued
+    // by the input thread belongs to the host side and is not saved.
+    void save_state(CheckpointWriter& out) const;
+    bool restore_state(CheckpointReader& in);
+
 private:
     // UART ID for identification
     int m_uart_id;
+    uint32_t m_irq_number;
     
     // UART Register Map (AC7805x compatible)
     enum UartRegisters {
@@ -77,9 +104,37 @@ private:
     // Register storage
     uint32_t m_registers[16];  // Support registers from 0x00 to 0x3C
     
-    // RX buffer for received characters
-    std::queue<uint8_t> m_rx_buffer;
-    std::mutex m_rx_mutex;
+    // Notifies an event from outside the SystemC thread: the input thread
+    // calls notify(), the kernel runs update() in its next update phase
+    class RxNotifier : public sc_prim_channel
+    {
+    public:
+        RxNotifier(const char* name, sc_event& event) : sc_prim_channel(name), m_event(event) {}
+        void notify() { async_request_update(); }
+        // Hold off starvation while an input thread may still notify
+        void keep_alive(bool enable) {
+            if (enable) {
+                async_attach_suspending();
+            } else {
+                async_detach_suspending();
+            }
+        }
+    private:
+        sc_event& m_event;
+        void update() override { m_event.notify(SC_ZERO_TIME); }
+    };
+
+    static const size_t RX_FIFO_DEPTH = 16;     // Receive FIFO seen by the firmware
+    static const size_t RX_RING_SIZE = 1024;    // Bytes in flight from the input thread
+
+    // Receive FIFO; only touched by SystemC processes
+    std::deque<uint8_t> m_rx_fifo;
+
+    // Input thread -> SystemC hand-off
+    SpscRing<uint8_t> m_rx_ring;
+    sc_event m_rx_event;                // Bytes arrived, or FIFO space freed
+    RxNotifier m_rx_notifier;
+    std::atomic<bool> m_rx_dropped;     // Input lost on a full ring (overrun)
     
     // xterm/PTY related members (similar to Trace module)
     int m_pt_slave;
@@ -87,6 +142,9 @@ private:
     int m_xterm_pid;
     
     // Input monitoring
+    int m_input_fd;                     // Descriptor the input thread reads
+    bool m_input_owned;                 // Opened here (file source)
+    bool m_input_paced;                 // Wait for ring space instead of dropping
     std::thread m_input_thread;
     std::atomic<bool> m_stop_input_thread;
     
@@ -102,10 +160,13 @@ private:
     
     // UART functionality
     void transmit_character(uint8_t ch);
-    void receive_character(uint8_t ch);
+    void receive_characters();
     void update_status_flags();
     void check_and_trigger_interrupts();
     
+    // Input source selection
+    bool open_input(const std::string& input);
+    
     // xterm/PTY setup (adapted from Trace module)
     void xterm_setup();
     void xterm_launch(char* slave_name) const;
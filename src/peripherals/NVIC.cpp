@@ -1,5 +1,6 @@
 #include "NVIC.h"
 #include "Log.h"
+#include "Checkpoint.h"
 #include <sstream>
 #include <cstring>
 
@@ -7,6 +8,7 @@ NVIC::NVIC(sc_module_name name) :
     sc_module(name),
     socket("socket"),
     cpu_socket("cpu_socket"),
+    irq_socket("irq_socket"),
     m_stk_ctrl(0),
     m_stk_load(0),
     m_stk_val(0),
@@ -32,6 +34,7 @@ NVIC::NVIC(sc_module_name name) :
     socket.register_b_transport(this, &NVIC::b_transport);
     socket.register_get_direct_mem_ptr(this, &NVIC::get_direct_mem_ptr);
     socket.register_transport_dbg(this, &NVIC::transport_dbg);
+    irq_socket.register_b_transport(this, &NVIC::irq_b_transport);
     
     // Start SysTick thread
     SC_THREAD(systick_thread);
@@ -307,6 +310,19 @@ void NVIC::trigger_irq(uint32_t irq_number)
     }
 }
 
+void NVIC::irq_b_transport(tlm_generic_payload& trans, sc_time& delay)
+{
+    if (trans.get_command() != TLM_WRITE_COMMAND || trans.get_data_length() < 4) {
+        trans.set_response_status(TLM_COMMAND_ERROR_RESPONSE);
+        return;
+    }
+    uint32_t level = *reinterpret_cast<uint32_t*>(trans.get_data_ptr());
+    if (level != 0) {
+        trigger_irq(static_cast<uint32_t>(trans.get_address()));
+    }
+    trans.set_response_status(TLM_OK_RESPONSE);
+}
+
 void NVIC::update_interrupt_state()
 {
     // Check if any enabled interrupts are pending
@@ -383,9 +399,18 @@ unsigned int NVIC::transport_dbg(tlm_generic_payload& trans)
 void NVIC::systick_thread()
 {
     LOG_INFO("NVIC: SysTick thread started");
+
+    // A restored checkpoint with SysTick running continues its countdown
+    bool resume = m_systick_resume_delay != SC_ZERO_TIME;
+    if (resume) {
+        wait(m_systick_resume_at);
+    }
+
     while (true) {
         // Wait until (re)programmed
-        wait(m_systick_wake);
+        if (!resume) {
+            wait(m_systick_wake);
+        }
 
         // Snapshot sequence to detect reprogramming during wait
         uint64_t seq = m_systick_seq;
@@ -400,14 +425,18 @@ void NVIC::systick_thread()
             m_stk_val = m_stk_load & 0x00FFFFFFu;
         }
 
-        // Model time per tick. If CLKSOURCE=1 and core 48MHz was assumed, 1 tick ~ 1/48MHz.
-        // We won't tie to CPU cycles yet; use a coarse nanosecond scale proportional to remaining counts.
-        // Choose 1 tick = 1 ns nominal; then remaining delay = VAL ns.
-        sc_time per_tick = sc_time(1, SC_NS);
+        // One tick per core clock cycle; remaining delay = VAL cycles
+        sc_time per_tick = m_clock_period;
         uint32_t remaining = m_stk_val & 0x00FFFFFFu;
         sc_time delay = per_tick * remaining;
+        if (resume) {
+            delay = m_systick_resume_delay;
+            m_systick_resume_delay = SC_ZERO_TIME;
+            resume = false;
+        }
 
         // Schedule timeout
+        m_systick_deadline = sc_time_stamp() + delay;
         wait(delay);
 
         // If reprogrammed in between, skip firing
@@ -429,4 +458,81 @@ void NVIC::systick_thread()
             m_systick_wake.notify(SC_ZERO_TIME);
         }
     }
-}
\ No newline at end of file
+}
+
+void NVIC::save_state(CheckpointWriter& out) const
+{
+    out.section("NVIC");
+    out.put_u32(m_actlr);
+    out.put_u32(m_stk_ctrl);
+    out.put_u32(m_stk_load);
+    out.put_u32(m_stk_val);
+    out.put_u32(m_stk_calib);
+    out.put_u32(m_cpuid);
+    out.put_u32(m_icsr);
+    out.put_u32(m_vtor);
+    out.put_u32(m_aircr);
+    out.put_u32(m_scr);
+    out.put_u32(m_ccr);
+    out.put_u32(m_shpr2);
+    out.put_u32(m_shpr3);
+    out.put_u32(m_shcsr);
+    out.put_u32(m_dfsr);
+    out.put_u32(m_iser);
+    out.put_u32(m_icer);
+    out.put_u32(m_ispr);
+    out.put_u32(m_icpr);
+    for (int i = 0; i < 8; i++) {
+        out.put_u32(m_ipr[i]);
+    }
+    out.put_u32(m_pending_exceptions);
+    out.put_u32(m_active_exceptions);
+
+    // SysTick timing: time left on the countdown in flight, if any
+    out.put_u64(m_systick_seq);
+    sc_time remaining = SC_ZERO_TIME;
+    bool running = (m_stk_ctrl & 1u) && (m_stk_load & 0x00FFFFFFu);
+    if (running && m_systick_deadline > sc_time_stamp()) {
+        remaining = m_systick_deadline - sc_time_stamp();
+    }
+    out.put_u64(remaining.value());
+}
+
+bool NVIC::restore_state(CheckpointReader& in, const sc_time& resume_time)
+{
+    if (!in.section("NVIC")) {
+        return false;
+    }
+    m_actlr = in.get_u32();
+    m_stk_ctrl = in.get_u32();
+    m_stk_load = in.get_u32();
+    m_stk_val = in.get_u32();
+    m_stk_calib = in.get_u32();
+    m_cpuid = in.get_u32();
+    m_icsr = in.get_u32();
+    m_vtor = in.get_u32();
+    m_aircr = in.get_u32();
+    m_scr = in.get_u32();
+    m_ccr = in.get_u32();
+    m_shpr2 = in.get_u32();
+    m_shpr3 = in.get_u32();
+    m_shcsr = in.get_u32();
+    m_dfsr = in.get_u32();
+    m_iser = in.get_u32();
+    m_icer = in.get_u32();
+    m_ispr = in.get_u32();
+    m_icpr = in.get_u32();
+    for (int i = 0; i < 8; i++) {
+        m_ipr[i] = in.get_u32();
+    }
+    m_pending_exceptions = in.get_u32();
+    m_active_exceptions = in.get_u32();
+
+    m_systick_seq = in.get_u64();
+    m_systick_resume_delay = sc_time::from_value(in.get_u64());
+    m_systick_resume_at = resume_time;
+    if (m_systick_resume_delay != SC_ZERO_TIME) {
+        m_systick_deadline = resume_time + m_systick_resume_delay;
+    }
+    return in.ok();
+}
@@ -10,12 +10,17 @@
 using namespace sc_core;
 using namespace tlm;
 
+class CheckpointWriter;
+class CheckpointReader;
+
 class NVIC : public sc_module, public tlm_fw_transport_if<>
 {
 public:
     // TLM sockets
     tlm_utils::simple_target_socket<NVIC> socket;      // For register access
     tlm_utils::simple_initiator_socket<NVIC> cpu_socket; // For CPU interrupt delivery
+    tlm_utils::simple_target_socket<NVIC> irq_socket;  // Peripheral interrupt lines: a write of
+                                                       // non-zero data to address n raises IRQ n
 
     // Constructor
     SC_HAS_PROCESS(NVIC);
@@ -34,6 +39,14 @@ public:
     void trigger_systick();
     void trigger_irq(uint32_t irq_number);
 
+    // SysTick counts processor clock ticks (CLKSOURCE is treated as the core clock)
+    void set_clock_period(const sc_time& period) { m_clock_period = period; }
+
+    // Checkpoint support. Restoring re-arms a running SysTick so it expires at
+    // the same simulated time as in the original run.
+    void save_state(CheckpointWriter& out) const;
+    bool restore_state(CheckpointReader& in, const sc_time& resume_time);
+
 private:
     uint32_t m_actlr;      // 0xE000E008 - Application Interrupt and Reset Control Register (AIRCR)
 
@@ -71,10 +84,15 @@ private:
     sc_event m_systick_wake;     // Wakes/retimes the SysTick scheduler
     sc_event m_systick_timeout;  // Timeout event for next SysTick expiry
     uint64_t m_systick_seq { 0 }; // Bumps on reprogram to invalidate old timeouts
+    sc_time m_systick_deadline;   // Expiry of the timeout being waited on
+    sc_time m_systick_resume_at;  // Restored checkpoint: when to re-arm
+    sc_time m_systick_resume_delay; // Restored checkpoint: time left until expiry
+    sc_time m_clock_period { 1, SC_NS }; // One SysTick count
 
     // Helper methods
     void handle_read(tlm_generic_payload& trans);
     void handle_write(tlm_generic_payload& trans);
+    void irq_b_transport(tlm_generic_payload& trans, sc_time& delay);
     void update_interrupt_state();
     void send_exception_to_cpu(uint32_t exception_type);
     uint32_t get_highest_priority_pending_exception();
@@ -8,6 +8,7 @@
 #include <sys/wait.h>
 
 #include "Trace.h"
+#include "SimulationControl.h"
 
 void Trace::xtermLaunch(char *slaveName) const {
     char *arg;
@@ -28,6 +29,7 @@ void Trace::xtermLaunch(char *slaveName) const {
     argv[2] = nullptr;
 
     execvp("xterm", argv);
+    _exit(1);                   // No xterm: do not fall back into the simulator
 }
 
 void Trace::xtermKill() {
@@ -45,6 +47,7 @@ void Trace::xtermKill() {
     if (xtermPid > 0) {            // Kill the terminal
         kill(xtermPid, SIGKILL);
         waitpid(xtermPid, nullptr, 0);
+        xtermPid = 0;
     }
 }
 
@@ -81,21 +84,97 @@ Trace::Trace(sc_core::sc_module_name const &name) :
 
     socket.register_b_transport(this, &Trace::b_transport);
 
-    xtermSetup();
+    outBuffer.reserve(BUFFER_SIZE);
 }
 
 Trace::~Trace() {
+    closeOutput();
+}
+
+bool Trace::set_output(const std::string &spec) {
+    closeOutput();
+
+    if (spec == "stdout") {
+        outFd = STDOUT_FILENO;
+    } else if (spec == "null") {
+        outFd = -1;
+    } else if (spec == "pty") {
+        xtermSetup();
+        outFd = ptSlave;
+        if (outFd == -1) {
+            std::cerr << "Trace: cannot open a pseudo terminal" << std::endl;
+            return false;
+        }
+    } else if (spec.rfind("file:", 0) == 0 && spec.size() > 5) {
+        outFd = open(spec.c_str() + 5, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (outFd == -1) {
+            std::cerr << "Trace: cannot create " << spec.substr(5) << std::endl;
+            return false;
+        }
+        outOwned = true;
+    } else {
+        std::cerr << "Trace: unknown output " << spec << " (expected stdout, file:<path>, pty or null)" << std::endl;
+        outFd = STDOUT_FILENO;
+        return false;
+    }
+    return true;
+}
+
+void Trace::flush() {
+    if (outBuffer.empty()) {
+        return;
+    }
+    if (outFd == STDOUT_FILENO) {
+        std::cout.flush();      // Keep order with the simulator's own messages
+    }
+    const char *data = outBuffer.data();
+    size_t left = outBuffer.size();
+    while (outFd != -1 && left > 0) {
+        ssize_t written = write(outFd, data, left);
+        if (written <= 0) {
+            break;
+        }
+        data += written;
+        left -= static_cast<size_t>(written);
+    }
+    outBuffer.clear();
+}
+
+void Trace::closeOutput() {
+    flush();
+    if (outOwned) {
+        close(outFd);
+        outOwned = false;
+    }
+    outFd = STDOUT_FILENO;
     xtermKill();
 }
 
+void Trace::end_of_simulation() {
+    flush();
+}
+
 void Trace::b_transport(tlm::tlm_generic_payload &trans,
                         sc_core::sc_time &delay) {
 
     unsigned char *ptr = trans.get_data_ptr();
     delay = sc_core::SC_ZERO_TIME;
 
-    ssize_t a = write(ptSlave, ptr, 1);
-    (void) a;
+    if (trans.get_command() == tlm::TLM_WRITE_COMMAND && trans.get_address() == EXIT_OFFSET) {
+        uint32_t code = 0;
+        for (unsigned int i = 0; i < trans.get_data_length() && i < 4; i++) {
+            code |= static_cast<uint32_t>(ptr[i]) << (8 * i);
+        }
+        flush();
+        SimulationControl::request_exit(static_cast<int>(code), "trace exit register");
+        trans.set_response_status(tlm::TLM_OK_RESPONSE);
+        return;
+    }
+
+    outBuffer.push_back(static_cast<char>(ptr[0]));
+    if (ptr[0] == '\n' || outBuffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
 
     trans.set_response_status(tlm::TLM_OK_RESPONSE);
 }
\ No newline at end of file
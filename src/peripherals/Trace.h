@@ -6,6 +6,8 @@
 #include <tlm_utils/simple_target_socket.h>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <unistd.h>
 
 using namespace sc_core;
 using namespace tlm;
@@ -29,21 +31,52 @@ public:
     */
     ~Trace() override;
 
+    /**
+    * @brief Register offsets. Any write outside EXIT_OFFSET prints its low byte;
+    * a write to EXIT_OFFSET ends the simulation with the written value as exit code.
+    */
+    static constexpr uint32_t EXIT_OFFSET = 0x04;
+
+    /**
+    * @brief Select the output sink: "stdout" (default), "file:<path>",
+    * "pty" (an xterm on a pseudo terminal) or "null".
+    * @return false if the spec is unknown or the sink cannot be opened
+    */
+    bool set_output(const std::string &spec);
+
+    /**
+    * @brief Output is buffered and written on newline, when this many
+    * bytes are pending, and when the simulation ends.
+    */
+    static constexpr size_t BUFFER_SIZE = 4096;
+
 private:
 
     // TLM-2 blocking transport method
     virtual void b_transport(tlm::tlm_generic_payload &trans,
                                 sc_core::sc_time &delay);
 
+    void end_of_simulation() override;
+
+    // Write out pending output
+    void flush();
+
+    // Flush and release the current sink
+    void closeOutput();
+
     void xtermLaunch(char *slaveName) const;
 
     void xtermKill();
 
     void xtermSetup();
 
-    int ptSlave{};
-    int ptMaster{};
+    int ptSlave{-1};
+    int ptMaster{-1};
     int xtermPid{};
+
+    int outFd{STDOUT_FILENO};   // -1 discards output
+    bool outOwned{false};       // outFd was opened for a file sink
+    std::string outBuffer;
 };
 
 #endif // TRACE_H
\ No newline at end of file
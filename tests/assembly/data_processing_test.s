@@ -78,8 +78,11 @@ _start:
     adr r0, test_data      @ Load address relative to PC
     add r1, sp, #64        @ Add immediate to SP
     
-    @ Infinite loop to end test
+    @ End test: write exit code 0 to the Trace exit register
 end_loop:
+    ldr r0, =0x40000004
+    movs r1, #0
+    str r1, [r0]
     b end_loop
 
 .align 2
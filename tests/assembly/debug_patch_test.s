@@ -0,0 +1,33 @@
+.syntax unified
+.thumb
+.text
+.global _start
+.global patch_site
+.global checkpoint
+
+@ Code patched over GDB must run, also from translated blocks (--engine=block).
+@ Driven by tools/gdb_patch_test.py: the first pass through `run` translates
+@ its block; the debugger stops at `checkpoint`, rewrites patch_site to
+@ "movs r0, #0" with an M packet and continues. The second pass re-enters the
+@ same block, so a stale translation exits with 1 and a flushed one with 0.
+@ Run without the debugger, the test exits with 1.
+
+_start:
+    movs r4, #0
+    b run                 @ `run` starts its own block
+
+run:
+patch_site:
+    movs r0, #1           @ Patched to movs r0, #0 (0x2000)
+    adds r4, r4, #1
+    cmp r4, #2
+    beq done
+checkpoint:
+    nop                   @ Breakpoint here after the first pass
+    b run
+
+done:
+    ldr r1, =0x40000004   @ Trace exit register: exit code = r0
+    str r0, [r1]
+end:
+    b end
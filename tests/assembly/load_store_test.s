@@ -86,8 +86,11 @@ _start:
     movs r4, #8
     ldrsh r2, [r1, r4]     @ Load sign-extended halfword
     
-    @ Infinite loop to end test
+    @ End test: write exit code 0 to the Trace exit register
 end_loop:
+    ldr r0, =0x40000004
+    movs r1, #0
+    str r1, [r0]
     b end_loop
 
 .align 2
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Throughput benchmark for ARM_M_TLM builds
+Runs each workload with every simulator binary given and reports host-side
+instructions per second, so two builds of the simulator can be compared on
+the same images. Process start-up is measured with a one-instruction run
+and subtracted.
+
+Switch dispatch against handlers resolved at decode time, for example:
+    git worktree add ../tlm-switch <commit before "Resolve instruction handlers at decode time">
+    (build both trees)
+    tools/bench_sim.py --sim switch=../tlm-switch/build/bin/arm_m_tlm \\
+                       --sim threaded=build/bin/arm_m_tlm tests/assembly/*.hex
+"""
+
+import re
+import sys
+import time
+import argparse
+import subprocess
+from typing import List, Tuple
+
+INSTRUCTIONS_RE = re.compile(r"Instructions executed:\s*(\d+)")
+
+
+def run_once(sim: str, image: str, max_instructions: int, extra: List[str]) -> Tuple[float, int]:
+    """Wall time and executed instruction count of one run"""
+    loader = "--elf" if image.endswith(".elf") else "--bin" if image.endswith(".bin") else "--hex"
+    command = [sim, loader, image, "--max-instructions", str(max_instructions),
+               "--max-time", "0", "--log", "/dev/null"] + extra
+    start = time.perf_counter()
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            stdin=subprocess.DEVNULL, universal_newlines=True)
+    elapsed = time.perf_counter() - start
+    match = INSTRUCTIONS_RE.search(result.stdout)
+    if not match:
+        raise RuntimeError("{} printed no instruction count for {} (exit code {})".format(
+            sim, image, result.returncode))
+    return elapsed, int(match.group(1))
+
+
+def measure(sim: str, image: str, args) -> Tuple[int, float]:
+    """Instructions executed and instructions per second (best of --repeat runs)"""
+    startup = min(run_once(sim, image, 1, args.extra)[0] for _ in range(args.repeat))
+    best = None
+    instructions = 0
+    for _ in range(args.repeat):
+        elapsed, instructions = run_once(sim, image, args.max_instructions, args.extra)
+        best = elapsed if best is None else min(best, elapsed)
+    busy = best - startup
+    if instructions <= 1 or busy <= 0:
+        return instructions, 0.0
+    return instructions, (instructions - 1) / busy
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare simulator builds on instructions per second")
+    parser.add_argument("images", nargs="+", help="workload images (.hex, .elf or .bin)")
+    parser.add_argument("--sim", action="append", required=True, metavar="NAME=PATH",
+                        help="simulator binary to measure; repeat to compare builds")
+    parser.add_argument("--max-instructions", type=int, default=20000000,
+                        help="instruction limit per run (default: 20000000)")
+    parser.add_argument("--repeat", type=int, default=3, help="runs per measurement, best is kept (default: 3)")
+    parser.add_argument("--extra", action="append", default=[], metavar="ARG",
+                        help="extra simulator argument, e.g. --extra=--engine=block; repeatable")
+    args = parser.parse_args()
+
+    sims = []
+    for spec in args.sim:
+        name, sep, path = spec.partition("=")
+        sims.append((name, path) if sep else (path, path))
+
+    header = "{:<32} {:>12}".format("workload", "instructions")
+    for name, _ in sims:
+        header += " {:>12}".format(name + " MIPS")
+    if len(sims) > 1:
+        header += " {:>8}".format("speedup")
+    print(header)
+
+    for image in args.images:
+        rates = []
+        instructions = 0
+        try:
+            for _, path in sims:
+                instructions, rate = measure(path, image, args)
+                rates.append(rate)
+        except (OSError, RuntimeError) as e:
+            print("{}: {}".format(image, e), file=sys.stderr)
+            continue
+        row = "{:<32} {:>12}".format(image.split("/")[-1], instructions)
+        for rate in rates:
+            row += " {:>12.2f}".format(rate / 1e6)
+        if len(sims) > 1:
+            row += " {:>7.2f}x".format(rates[-1] / rates[0] if rates[0] else 0.0)
+        print(row)
+
+
+if __name__ == "__main__":
+    main()
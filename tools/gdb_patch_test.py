@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+Code patch test over the GDB remote protocol
+Runs tests/assembly/debug_patch_test.elf under the GDB server, stops at its
+`checkpoint` breakpoint, rewrites `patch_site` with an M packet and lets the
+program finish. Passes when the simulator exits with 0, i.e. the patched
+instruction ran rather than a stale decode or translated block.
+
+    tools/gdb_patch_test.py --simulator build/bin/arm_m_tlm \\
+        --elf tests/assembly/debug_patch_test.elf --engine block
+"""
+
+import sys
+import time
+import socket
+import argparse
+import subprocess
+
+PATCH = "0020"  # movs r0, #0, little endian
+
+
+def symbols(nm: str, elf: str) -> dict:
+    """Symbol name -> address from the ELF"""
+    output = subprocess.check_output([nm, elf], universal_newlines=True)
+    table = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3:
+            table[fields[2]] = int(fields[0], 16)
+    return table
+
+
+class RemoteTarget:
+    """Just enough of the GDB remote serial protocol for this test"""
+
+    def __init__(self, port: int, timeout: float):
+        deadline = time.time() + timeout
+        while True:
+            try:
+                self.sock = socket.create_connection(("localhost", port), timeout=timeout)
+                break
+            except OSError:
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.1)
+        self.buffer = b""
+
+    def send(self, data: str):
+        checksum = sum(data.encode()) & 0xFF
+        self.sock.sendall("${}#{:02x}".format(data, checksum).encode())
+
+    def receive(self) -> str:
+        """Next packet payload; acks and other noise are skipped"""
+        while True:
+            start = self.buffer.find(b"$")
+            end = self.buffer.find(b"#", start + 1) if start != -1 else -1
+            if end != -1 and len(self.buffer) >= end + 3:
+                payload = self.buffer[start + 1:end].decode()
+                self.buffer = self.buffer[end + 3:]
+                self.sock.sendall(b"+")
+                return payload
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("simulator closed the connection")
+            self.buffer += chunk
+
+    def command(self, data: str) -> str:
+        self.send(data)
+        return self.receive()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Patch code over GDB and check that the patch runs")
+    parser.add_argument("--simulator", required=True, help="simulator binary")
+    parser.add_argument("--elf", required=True, help="debug_patch_test.elf")
+    parser.add_argument("--engine", default="block", help="execution engine (default: block)")
+    parser.add_argument("--port", type=int, default=3333, help="GDB server port (default: 3333)")
+    parser.add_argument("--nm", default="arm-none-eabi-nm", help="nm for the ARM ELF")
+    parser.add_argument("--timeout", type=float, default=30.0, help="seconds before the test fails")
+    args = parser.parse_args()
+
+    table = symbols(args.nm, args.elf)
+    patch_site = table["patch_site"]
+    checkpoint = table["checkpoint"]
+
+    sim = subprocess.Popen([args.simulator, "--elf", args.elf, "--engine=" + args.engine,
+                            "--gdb-port", str(args.port), "--log", "/dev/null"],
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        target = RemoteTarget(args.port, args.timeout)
+        target.receive()  # Initial stop
+        if target.command("Z0,{:x},2".format(checkpoint)) != "OK":
+            raise RuntimeError("cannot set breakpoint at 0x{:x}".format(checkpoint))
+        target.send("c")
+        stop = target.receive()
+        if not stop.startswith(("S05", "T05")):
+            raise RuntimeError("unexpected stop reply: " + stop)
+        target.command("z0,{:x},2".format(checkpoint))
+        if target.command("M{:x},2:{}".format(patch_site, PATCH)) != "OK":
+            raise RuntimeError("cannot patch 0x{:x}".format(patch_site))
+        target.send("c")
+        code = sim.wait(timeout=args.timeout)
+    except Exception as e:
+        sim.kill()
+        sim.wait()
+        print("FAIL: {}".format(e))
+        return 1
+
+    if code != 0:
+        print("FAIL: exit code {} (patched code did not run)".format(code))
+        return 1
+    print("PASS: patched code ran with --engine={}".format(args.engine))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
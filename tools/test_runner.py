@@ -116,11 +116,16 @@ class TestRunner:
             # Parse output for metrics
             metrics = self.parse_performance_report(result.stdout)
             
-            # Determine test status
+            # Determine test status. Tests that end through semihosting SYS_EXIT
+            # or the Trace exit register report their result in the exit code;
+            # older tests that just spin are judged by their log output.
             status = "PASS"
-            if result.returncode != 0:
+            exited = re.search(r'Program exited with code (-?\d+)', result.stdout)
+            if result.returncode == 124:
+                status = "TIMEOUT"
+            elif result.returncode != 0:
                 status = "FAIL"
-            elif "ERROR" in result.stdout or "Failed" in result.stdout:
+            elif not exited and ("ERROR" in result.stdout or "Failed" in result.stdout):
                 status = "FAIL"
             
             return TestResult(
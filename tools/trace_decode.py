@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""
+Decoder for ARM_M_TLM binary execution traces (--inst-trace)
+Expands a trace to text, optionally keeping only instructions in a PC range
+or instructions whose data accesses touch an address range
+"""
+
+import sys
+import struct
+import argparse
+from typing import Iterator, List, Tuple
+
+MAGIC = b"ATRC"
+VERSION = 1
+FLAG_COMPRESSED = 0x01
+
+TAG_NEXT = 0x00
+TAG_JUMP = 0x01
+TAG_NEW16 = 0x02
+TAG_NEW32 = 0x03
+TAG_EXCEPTION = 0x04
+TAG_REGISTER = 0x10
+TAG_MEMORY = 0x20
+TAG_MEMORY_WRITE = 0x04
+
+MIN_MATCH = 4
+
+REGISTER_NAMES = ["r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+                  "r8", "r9", "r10", "r11", "r12", "sp", "lr", "pc"]
+
+
+def decompress(data: bytes, out_size: int) -> bytes:
+    """Inverse of Compression::compress (LZ4-style sequences)"""
+    out = bytearray()
+    ip = 0
+    end = len(data)
+
+    def get_length(length: int) -> int:
+        nonlocal ip
+        while True:
+            b = data[ip]
+            ip += 1
+            length += b
+            if b != 255:
+                return length
+
+    while ip < end:
+        token = data[ip]
+        ip += 1
+        literal_count = token >> 4
+        if literal_count == 15:
+            literal_count = get_length(literal_count)
+        out += data[ip:ip + literal_count]
+        ip += literal_count
+        if ip >= end:
+            break
+        offset = data[ip] | (data[ip + 1] << 8)
+        ip += 2
+        match_length = token & 0x0F
+        if match_length == 15:
+            match_length = get_length(match_length)
+        match_length += MIN_MATCH
+        if offset == 0 or offset > len(out):
+            raise ValueError("corrupt compressed block")
+        start = len(out) - offset
+        # Byte copy: the match may overlap the bytes being produced
+        for i in range(match_length):
+            out.append(out[start + i])
+    if len(out) != out_size:
+        raise ValueError("corrupt compressed block")
+    return bytes(out)
+
+
+def read_blocks(path: str) -> Iterator[bytes]:
+    """Yield the raw (decompressed) payload of every block in the file"""
+    with open(path, "rb") as f:
+        header = f.read(6)
+        if len(header) != 6 or header[:4] != MAGIC:
+            raise ValueError(f"{path}: not an execution trace")
+        if header[4] != VERSION:
+            raise ValueError(f"{path}: unsupported trace version {header[4]}")
+        while True:
+            sizes = f.read(8)
+            if not sizes:
+                return
+            if len(sizes) != 8:
+                raise ValueError(f"{path}: truncated block header")
+            raw_size, stored_size = struct.unpack("<II", sizes)
+            payload = f.read(stored_size)
+            if len(payload) != stored_size:
+                raise ValueError(f"{path}: truncated block")
+            yield payload if stored_size == raw_size else decompress(payload, raw_size)
+
+
+def unzigzag(value: int) -> int:
+    return (value >> 1) ^ -(value & 1)
+
+
+class TraceDecoder:
+    """Replays the delta state of the writer (src/helpers/InstructionTrace.h)"""
+
+    def __init__(self):
+        self.next_pc = 0
+        self.last_address = 0
+        self.opcodes = {}  # PC -> (opcode, length)
+
+    def records(self, path: str) -> Iterator[Tuple]:
+        """Yield ("insn", pc, opcode, length), ("reg", n, value),
+        ("mem", address, value, size, write) and ("exc", number)"""
+        for block in read_blocks(path):
+            pos = 0
+            end = len(block)
+
+            def varint() -> int:
+                nonlocal pos
+                value = 0
+                shift = 0
+                while True:
+                    b = block[pos]
+                    pos += 1
+                    value |= (b & 0x7F) << shift
+                    if b < 0x80:
+                        return value
+                    shift += 7
+
+            while pos < end:
+                tag = block[pos]
+                pos += 1
+                if tag <= TAG_NEW32:
+                    pc = self.next_pc
+                    if tag != TAG_NEXT:
+                        pc = (pc + unzigzag(varint())) & 0xFFFFFFFF
+                    if tag >= TAG_NEW16:
+                        self.opcodes[pc] = (varint(), 4 if tag == TAG_NEW32 else 2)
+                    opcode, length = self.opcodes.get(pc, (0, 2))
+                    self.next_pc = (pc + length) & 0xFFFFFFFF
+                    yield ("insn", pc, opcode, length)
+                elif tag == TAG_EXCEPTION:
+                    yield ("exc", varint())
+                elif tag & 0xF0 == TAG_REGISTER:
+                    yield ("reg", tag & 0x0F, varint())
+                elif tag & 0xF8 == TAG_MEMORY:
+                    address = (self.last_address + unzigzag(varint())) & 0xFFFFFFFF
+                    self.last_address = address
+                    yield ("mem", address, varint(), 1 << (tag & 0x03), bool(tag & TAG_MEMORY_WRITE))
+                else:
+                    raise ValueError(f"unknown record tag 0x{tag:02x}")
+
+
+def format_record(record: Tuple) -> str:
+    kind = record[0]
+    if kind == "insn":
+        _, pc, opcode, length = record
+        text = f"{opcode >> 16:04x} {opcode & 0xFFFF:04x}" if length == 4 else f"{opcode:04x}"
+        return f"0x{pc:08x}: {text}"
+    if kind == "reg":
+        return f"    {REGISTER_NAMES[record[1]]} = 0x{record[2]:08x}"
+    if kind == "mem":
+        _, address, value, size, write = record
+        return f"    {'WRITE' if write else 'READ '} [0x{address:08x}] = 0x{value:0{size * 2}x} ({size})"
+    return f"*** exception {record[1]}"
+
+
+def parse_range(text: str) -> Tuple[int, int]:
+    """"lo:hi" (hi exclusive), numbers in any base Python accepts (0x...)"""
+    lo, sep, hi = text.partition(":")
+    if not sep:
+        raise argparse.ArgumentTypeError(f"expected lo:hi, got {text}")
+    return int(lo, 0), int(hi, 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Expand an ARM_M_TLM binary execution trace to text")
+    parser.add_argument("trace", help="Trace file written with --inst-trace")
+    parser.add_argument("--pc", type=parse_range, action="append", default=[], metavar="LO:HI",
+                        help="Only instructions with LO <= PC < HI (repeatable)")
+    parser.add_argument("--data", type=parse_range, action="append", default=[], metavar="LO:HI",
+                        help="Only instructions that access memory in LO..HI (repeatable)")
+    parser.add_argument("--no-effects", action="store_true", help="Print instructions only")
+    parser.add_argument("--limit", type=int, default=0, help="Stop after N printed instructions")
+    parser.add_argument("--stats", action="store_true", help="Print record counts instead of the trace")
+    args = parser.parse_args()
+
+    def in_ranges(value: int, ranges: List[Tuple[int, int]]) -> bool:
+        return any(lo <= value < hi for lo, hi in ranges)
+
+    counts = {"insn": 0, "reg": 0, "mem": 0, "exc": 0}
+    printed = 0
+    pending: List[Tuple] = []  # Current instruction and its effects
+    out = sys.stdout
+
+    def emit(group: List[Tuple]) -> bool:
+        """Print one instruction group if it passes the filters; False at the limit"""
+        nonlocal printed
+        if not group:
+            return True
+        head = group[0]
+        if head[0] == "insn":
+            if args.pc and not in_ranges(head[1], args.pc):
+                return True
+            if args.data and not any(r[0] == "mem" and in_ranges(r[1], args.data) for r in group):
+                return True
+            printed += 1
+        elif args.pc or args.data:
+            return True
+        for record in group:
+            if args.no_effects and record[0] in ("reg", "mem"):
+                continue
+            out.write(format_record(record) + "\n")
+        return not args.limit or printed < args.limit
+
+    try:
+        for record in TraceDecoder().records(args.trace):
+            counts[record[0]] += 1
+            if args.stats:
+                continue
+            if record[0] in ("insn", "exc"):
+                if not emit(pending):
+                    return 0
+                pending = []
+            pending.append(record)
+        if not args.stats:
+            emit(pending)
+    except BrokenPipeError:
+        return 0
+    except (OSError, ValueError, IndexError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+    if args.stats:
+        print(f"Instructions:     {counts['insn']}")
+        print(f"Register writes:  {counts['reg']}")
+        print(f"Memory accesses:  {counts['mem']}")
+        print(f"Exceptions:       {counts['exc']}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())